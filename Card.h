@@ -0,0 +1,118 @@
+#ifndef CARD_H
+#define CARD_H
+#include <array>            // array
+#include <cstdint>          // uint8_t
+#include "WireFormat.h"     // CARD_RANK_COUNT, CARD_NAMES
+
+// A card held in one byte. The low four bits are its rank, numbered the same as
+// its protocol 2 card code, and the two above them are its suit. Hands and shoes
+// are plain byte arrays, so a whole shoe is filled with one copy and shuffled or
+// dealt without touching the heap.
+
+/*===============================================================
+||                       Public Constants                      ||
+===============================================================*/
+const int CARDS_IN_STANDARD_DECK = 52;  // The number of cards in a standard deck
+const int CARD_SUIT_COUNT = 4;          // The number of suits in a standard deck
+const int CARD_SUIT_SHIFT = 4;          // Where the suit starts in a card
+const uint8_t CARD_RANK_MASK = 0x0F;    // The bits of a card holding its rank
+const int ACE_RANK = 12;                // The rank of an ace
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+typedef uint8_t Card;                   // A rank and suit in one byte
+const Card NO_CARD = 0xFF;              // Stands for no card, like a hidden card not yet dealt
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            MakeCard                           *
+*------------------------- Description -------------------------*
+* Pack a rank and suit into a card.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int rank: The rank, as an index in CARD_NAMES.          *
+*                                                               *
+* const int suit: The suit, from 0 to CARD_SUIT_COUNT - 1.      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the card.                                             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+constexpr Card MakeCard(const int rank, const int suit)
+{
+    return (Card) ((suit << CARD_SUIT_SHIFT) | rank);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            CardRank                           *
+*------------------------- Description -------------------------*
+* Find the rank of a card, which is also its protocol 2 code.   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Card card: The card.                                    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the index of the card's rank in CARD_NAMES. Returns   *
+* CARD_RANK_COUNT or more for NO_CARD.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+constexpr int CardRank(const Card card)
+{
+    return card & CARD_RANK_MASK;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            CardName                           *
+*------------------------- Description -------------------------*
+* Find the name a card is shown to players by.                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Card card: The card.                                    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the card's rank as named in CARD_NAMES. Returns an    *
+* empty name for NO_CARD.                                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+inline const char* CardName(const Card card)
+{
+    if (CardRank(card) >= CARD_RANK_COUNT)
+    {
+        return "";
+    }
+    return CARD_NAMES[CardRank(card)];
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            MakeShoe                           *
+*------------------------- Description -------------------------*
+* Build an unshuffled shoe of DECKS standard decks at compile   *
+* time, each deck in suit then rank order.                      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the shoe.                                             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <int DECKS>
+constexpr std::array<Card, DECKS * CARDS_IN_STANDARD_DECK> MakeShoe()
+{
+    std::array<Card, DECKS * CARDS_IN_STANDARD_DECK> shoe{};
+    int at = 0;
+    for (int deck = 0; deck < DECKS; deck++)
+    {
+        for (int suit = 0; suit < CARD_SUIT_COUNT; suit++)
+        {
+            for (int rank = 0; rank < CARD_RANK_COUNT; rank++)
+            {
+                shoe[at++] = MakeCard(rank, suit);
+            }
+        }
+    }
+    return shoe;
+}
+
+#endif
@@ -7,10 +7,11 @@
 
 //function headers
 void DisplayGames(std::string buffer);
+std::string FormatLobbyPage(const LobbyPage &page);
 std::string StringToLower(const std::string source);
-bool HandleUserSelectedGame(std::string buffer, ClientConnection *client);
+bool HandleUserSelectedGame(ClientConnection *client);
 void ExitGame(ClientConnection *client);
-void DisplayPlayer(const int playerIndex, const int money, const int bet, const std::vector<std::string> *cards, const int myIndex);
+void DisplayPlayer(const int playerIndex, const int money, const int bet, const std::vector<Card> *cards, const int myIndex);
 bool HandleNewGameState(ClientConnection *client, bool &isMyTurn, bool &isNextRound, bool doDisplay = true);
 bool HandlePlayerBet(ClientConnection *client);
 bool WaitForMyTurn(ClientConnection *client);
@@ -28,19 +29,16 @@ int main()
     client.Register();
     bool stillConnected;
 
-    // list games
-    char gameList[LIST_GAME_BUFFER_SIZE];
-    stillConnected = client.ListGames(gameList);
+    // keep the list of games up to date while the user picks
+    stillConnected = client.SubscribeToLobby();
     if (!stillConnected)
     {
-        // Could also occur if no games to read
-        //ExitGame(&client);
-        //return 0;
+        ExitGame(&client);
+        return 0;
     }
-    DisplayGames(gameList);
 
     // Have user pick a game
-    stillConnected = HandleUserSelectedGame(gameList, &client);
+    stillConnected = HandleUserSelectedGame(&client);
     if (!stillConnected)
     {
         ExitGame(&client);
@@ -98,13 +96,48 @@ void DisplayGames(std::string buffer)
     std::cout << "Please perform one of the following options:" << std::endl;
     std::cout << "1. Type the name of an available room to join it." << std::endl;
     std::cout << "2. Type the name of a non-existing room to create it (Max of 8 characters)." << std::endl;
-    std::cout << "3. Type 'exit' to leave the program." << std::endl << std::endl;
+    std::cout << "3. Type '/' and the start of a name to only list rooms starting with it." << std::endl;
+    std::cout << "4. Type '+' to only list rooms with a free seat, or to list every room again." << std::endl;
+    std::cout << "5. Type '>' to see the next page of rooms." << std::endl;
+    std::cout << "6. Type '*' to be seated at any table with a free seat." << std::endl;
+    std::cout << "7. Type 'exit' to leave the program." << std::endl << std::endl;
     std::cout << "Available Games:" << std::endl;
     std::cout << "=====================================================" << std::endl;
     std::cout << buffer << std::endl;
     std::cout << "=====================================================" << std::endl << std::endl;
 }
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        FormatLobbyPage                        *
+*------------------------- Description -------------------------*
+* Given a page of games, list them for the user.                *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const LobbyPage &page: The page of games to list.             *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns each game and its seats taken seperated by '\n', or   *
+* "<no games>\n" if the page is empty.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+std::string FormatLobbyPage(const LobbyPage &page)
+{
+    if (page.names.empty())
+    {
+        return "<no games>\n";
+    }
+    std::string list = "";
+    for (size_t i = 0; i < page.names.size(); i++)
+    {
+        list += page.names[i] + " (" + std::to_string(page.seatsTaken[i]) + "/" + std::to_string(PLAYER_COUNT) + " seats)\n";
+    }
+    if (!page.nextPageAfter.empty())
+    {
+        list += "...\n";
+    }
+    return list;
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                         StringToLower                         *
 *------------------------- Description -------------------------*
@@ -131,12 +164,12 @@ std::string StringToLower(const std::string source)
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                     HandleUserSelectedGame                    *
 *------------------------- Description -------------------------*
-* Given a list of games and a connection to the server, handle  *
-* the user until they join a game or exit from the server.      *
+* Given a connection to the server, show the user a page of the *
+* games and handle them until they join a game or exit from the *
+* server. The page is searched for again each time the user     *
+* changes it or the server pushes a change to the games.        *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* const std::string buffer: The list of games seperated by '\n'.*
-*                                                               *
 * ClientConnection *client: The client connection to talk to the*
 *   server through.                                             *
 *                                                               *
@@ -145,49 +178,125 @@ std::string StringToLower(const std::string source)
 * Returns false if the connection to the server has terminated. *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-bool HandleUserSelectedGame(const std::string buffer, ClientConnection *client)
+bool HandleUserSelectedGame(ClientConnection *client)
 {
-    bool waitingForUser = true;
-    while (waitingForUser)
+    std::string prefix = "";        // What the names listed start with
+    bool freeSeatsOnly = false;     // True: Only rooms with a free seat are listed
+    std::string pageAfter = "";     // The name the page listed starts after
+    LobbyPage page;
+    bool needsSearch = true;
+    while (true)
     {
-        waitingForUser = false;
+        // show the games again whenever the page or the games change
+        if (needsSearch)
+        {
+            if (!client->SearchGames(prefix, freeSeatsOnly, pageAfter, page))
+            {
+                return false;
+            }
+            DisplayGames(FormatLobbyPage(page));
+            needsSearch = false;
+        }
+        bool isUserReady;
+        if (!client->WaitForLobbyChange(isUserReady))
+        {
+            return false;
+        }
+        if (!isUserReady)
+        {
+            needsSearch = true;
+            continue;
+        }
+
         // get user input
         std::string userInput;
         std::getline(std::cin, userInput);
+        std::string name = StringToLower(userInput);
 
         // check for empty string
         if (userInput.compare("") == 0)
         {
             std::cout << "Invalid Input, please try again." << std::endl;
-            waitingForUser = true;
         }
 
         // check for exit 
-        else if (StringToLower(userInput).compare("exit") == 0)
+        else if (name.compare("exit") == 0)
         {
             return false;
         }
 
-        // join game
-        else if ((buffer.find(StringToLower(userInput)) != std::string::npos) && (buffer.compare("<no games>\n") != 0))
+        // only list rooms starting with the text
+        else if (userInput[0] == '/')
         {
-            return client->JoinGame(StringToLower(userInput));
+            prefix = name.substr(1);
+            pageAfter = "";
+            needsSearch = true;
         }
 
-        // create game
-        else if ((userInput.length() <= MAX_ROOM_NAME_LENGTH))
+        // only list rooms with a free seat, or go back to listing them all
+        else if (userInput.compare("+") == 0)
         {
-            return client->CreateGame(StringToLower(userInput));
+            freeSeatsOnly = !freeSeatsOnly;
+            pageAfter = "";
+            needsSearch = true;
         }
 
-        // Invalid input
+        // list the next page
+        else if (userInput.compare(">") == 0)
+        {
+            if (page.nextPageAfter.empty())
+            {
+                std::cout << "There are no more rooms." << std::endl;
+            }
+            else
+            {
+                pageAfter = page.nextPageAfter;
+                needsSearch = true;
+            }
+        }
+
+        // take a seat at whichever table has one
+        else if (userInput.compare("*") == 0)
+        {
+            bool isSeated;
+            if (!client->QuickJoin(isSeated))
+            {
+                return false;
+            }
+            if (isSeated)
+            {
+                return true;
+            }
+            std::cout << "No seat is free right now, please try again." << std::endl;
+        }
+
+        // join game if a room has the whole name. A name sorts ahead of any
+        // longer name it starts, so it is the first match if it exists
         else
         {
-            std::cout << "Invalid Input, please try again." << std::endl;
-            waitingForUser = true;
+            LobbyPage match;
+            if (!client->SearchGames(name, false, "", match))
+            {
+                return false;
+            }
+            if (!match.names.empty() && match.names[0].compare(name) == 0)
+            {
+                return client->JoinTable(match.tableIds[0]);
+            }
+
+            // create game
+            else if (name.length() <= MAX_ROOM_NAME_LENGTH)
+            {
+                return client->CreateGame(name);
+            }
+
+            // Invalid input
+            else
+            {
+                std::cout << "Invalid Input, please try again." << std::endl;
+            }
         }
     }
-    return true;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -219,13 +328,13 @@ void ExitGame(ClientConnection *client)
 *                                                               *
 * const int bet: The displayed player's bet.                    *
 *                                                               *
-* const std::vector<std::string> *cards: The displayed player's *
-*   shown cards.                                                *
+* const std::vector<Card> *cards: The displayed player's shown  *
+*   cards.                                                      *
 *                                                               *
 * const int myIndex: The client's index.                        *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void DisplayPlayer(const int playerIndex, const int money, const int bet, const std::vector<std::string> *cards, const int myIndex)
+void DisplayPlayer(const int playerIndex, const int money, const int bet, const std::vector<Card> *cards, const int myIndex)
 {
     if (playerIndex == PLAYER_COUNT)
     {
@@ -252,7 +361,7 @@ void DisplayPlayer(const int playerIndex, const int money, const int bet, const
     std::cout << "\tHand: ";
     for (int i = 0; i < cards->size(); i++)
     {
-        std::cout << cards->at(i);
+        std::cout << CardName(cards->at(i));
         if(i != (cards->size() - 1))
         {
             std::cout << ", ";
@@ -7,7 +7,11 @@
 #include <unistd.h>         // read, write, close
 #include <strings.h>        // bzero
 #include <netinet/tcp.h>    // SO_REUSEADDR
-#include <cstring>          // strlen
+#include <cstring>          // strlen, memcpy, memmove
+#include <cerrno>           // errno, EINTR
+#include <sys/uio.h>        // iovec
+#include <poll.h>           // poll
+#include <vector>           // vector
 //#include <iostream>         // cout (debugging)
 
 /*===============================================================
@@ -15,6 +19,17 @@
 ===============================================================*/
 const int BROADCAST_PORT = 2927;    // The server discovery port
 const int GAME_PORT = 2928;         // The server game port
+const int FRAME_HEADER_SIZE = 4;    // The bytes in front of every message holding its length
+const int MAX_FRAME_SIZE = 65536;   // The largest message the server may send
+const int RECEIVE_CHUNK_SIZE = 4096;// The most bytes pulled off the socket per read
+
+/*===============================================================
+||                        Private Data                         ||
+===============================================================*/
+// The bytes read from the server that have not been handed out as messages yet
+std::vector<char> receivedData;
+size_t receivedStart = 0;   // The first byte not handed out yet
+size_t receivedEnd = 0;     // One past the last byte read
 
 /*===============================================================
 ||                       Public Functions                      ||
@@ -101,17 +116,19 @@ void JoinServer(const int broadcastSocket, int& gameSocket)
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                       ReadDataFromServer                      *
 *------------------------- Description -------------------------*
-* Reads bufferSize bytes from the socket into buffer using TCP  *
+* Reads the next message from the socket into buffer using TCP. *
+* Extra bytes read past the end of the message are kept for the *
+* next call, and a message split across reads is put back       *
+* together.                                                     *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
 *   server about the game. Set up using JoinServer().           *
 *                                                               *
-* char buffer[]: Where the data read from the server will be    *
-*   placed.                                                     *
+* char buffer[]: Where the message read from the server will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
 *                                                               *
-* const int bufferSize: The amount of bytes to read from the    *
-*   server into the buffer.                                     *
+* const int bufferSize: The size of buffer.                     *
 *                                                               *
 *------------------------- Return Value ------------------------*
 * Returns true if the connection to the server is still active. *
@@ -120,26 +137,89 @@ void JoinServer(const int broadcastSocket, int& gameSocket)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ReadDataFromServer(const int socket, char buffer[], const int bufferSize)
 {
-    ssize_t bytes = read(socket, buffer, bufferSize - 1);
-    if (bytes > 0)
+    int length;
+    return ReadDataFromServer(socket, buffer, bufferSize, length);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       ReadDataFromServer                      *
+*------------------------- Description -------------------------*
+* Reads the next message from the socket into buffer, and says  *
+* how long it is. Used for messages that may hold a zero byte.  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   server about the game. Set up using JoinServer().           *
+*                                                               *
+* char buffer[]: Where the message read from the server will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+* int &length: Set to the number of bytes placed in buffer, not *
+*   counting the null.                                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ReadDataFromServer(const int socket, char buffer[], const int bufferSize, int &length)
+{
+    while (true)
     {
-        if (bytes < bufferSize)
+        // hand out the next message once all of it has been read
+        size_t available = receivedEnd - receivedStart;
+        if (available >= FRAME_HEADER_SIZE)
+        {
+            uint32_t frameLength;
+            memcpy(&frameLength, &receivedData[receivedStart], FRAME_HEADER_SIZE);
+            frameLength = ntohl(frameLength);
+            if (frameLength > MAX_FRAME_SIZE)
+            {
+                return false;
+            }
+            if (available >= FRAME_HEADER_SIZE + frameLength)
+            {
+                size_t copied = frameLength < (size_t) (bufferSize - 1) ? frameLength : bufferSize - 1;
+                memcpy(buffer, &receivedData[receivedStart + FRAME_HEADER_SIZE], copied);
+                buffer[copied] = '\0';
+                receivedStart += FRAME_HEADER_SIZE + frameLength;
+                length = (int) copied;
+                return true;
+            }
+        }
+
+        // make room at the end for another read
+        if (receivedData.size() - receivedEnd < RECEIVE_CHUNK_SIZE && receivedStart > 0)
         {
-            buffer[bytes] = '\0';
+            memmove(receivedData.data(), &receivedData[receivedStart], receivedEnd - receivedStart);
+            receivedEnd -= receivedStart;
+            receivedStart = 0;
         }
-        else
+        if (receivedData.size() - receivedEnd < RECEIVE_CHUNK_SIZE)
         {
-            buffer[bufferSize - 1] = '\0';
+            receivedData.resize(receivedEnd + RECEIVE_CHUNK_SIZE);
         }
-        return true;
+
+        ssize_t bytes;
+        do
+        {
+            bytes = read(socket, &receivedData[receivedEnd], RECEIVE_CHUNK_SIZE);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes <= 0)
+        {
+            return false;
+        }
+        receivedEnd += bytes;
     }
-    return false;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        SendDataToServer                       *
 *------------------------- Description -------------------------*
-* Sends data to the socket using a TCP connection.              *
+* Sends data to the socket as one message using a TCP           *
+* connection. The length of the data is sent in front of it.    *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
@@ -154,14 +234,116 @@ bool ReadDataFromServer(const int socket, char buffer[], const int bufferSize)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool SendDataToServer(const int socket, const char data[])
 {
-    int x = write(socket, data, strlen(data) );
-    if ( x < 0 )
+    return SendDataToServer(socket, data, strlen(data));
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendDataToServer                       *
+*------------------------- Description -------------------------*
+* Sends data of a known length to the socket as one message.    *
+* Used for messages that may hold a zero byte.                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   server about the game. Set up using JoinServer().           *
+*                                                               *
+* const char data[]: The data to send to the server.            *
+*                                                               *
+* const size_t length: The number of bytes of data to send.     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool SendDataToServer(const int socket, const char data[], const size_t length)
+{
+    uint32_t header = htonl((uint32_t) length);
+
+    // send the header and the data together, finishing any short write
+    iovec parts[2];
+    parts[0].iov_base = &header;
+    parts[0].iov_len = FRAME_HEADER_SIZE;
+    parts[1].iov_base = (void*) data;
+    parts[1].iov_len = length;
+    iovec* left = parts;
+    int leftCount = 2;
+    while (leftCount > 0)
     {
-        return false;
+        msghdr message;
+        bzero((char*) &message, sizeof(message));
+        message.msg_iov = left;
+        message.msg_iovlen = leftCount;
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        while (leftCount > 0 && (size_t) sent >= left[0].iov_len)
+        {
+            sent -= left[0].iov_len;
+            left++;
+            leftCount--;
+        }
+        if (leftCount > 0)
+        {
+            left[0].iov_base = (char*) left[0].iov_base + sent;
+            left[0].iov_len -= sent;
+        }
     }
     return true;
 }
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       WaitForServerOrUser                     *
+*------------------------- Description -------------------------*
+* Waits until either the server has sent data or the user has   *
+* typed something, whichever is first. Returns right away if a  *
+* whole message from the server has already been read.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   server about the game. Set up using JoinServer().           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the server is ready to be read from, or has   *
+* disconnected. Returns false if the user's input is ready.     *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WaitForServerOrUser(const int socket)
+{
+    // a message already read off the socket won't wake poll
+    size_t available = receivedEnd - receivedStart;
+    if (available >= FRAME_HEADER_SIZE)
+    {
+        uint32_t length;
+        memcpy(&length, &receivedData[receivedStart], FRAME_HEADER_SIZE);
+        if (available >= FRAME_HEADER_SIZE + ntohl(length))
+        {
+            return true;
+        }
+    }
+
+    pollfd watched[2];
+    watched[0].fd = socket;
+    watched[0].events = POLLIN;
+    watched[1].fd = STDIN_FILENO;
+    watched[1].events = POLLIN;
+    while (poll(watched, 2, -1) < 0)
+    {
+        // a failed wait is passed on to the next read from the server
+        if (errno != EINTR)
+        {
+            return true;
+        }
+    }
+    return watched[0].revents != 0;
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        CloseConnection                        *
 *------------------------- Description -------------------------*
@@ -178,5 +360,9 @@ bool SendDataToServer(const int socket, const char data[])
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 void CloseConnection(const int socket)
 {
+    // unread bytes belonged to this connection
+    receivedData.clear();
+    receivedStart = 0;
+    receivedEnd = 0;
     close(socket);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #ifndef CLIENTAPI_H
 #define CLIENTAPI_H
+#include <cstddef>          // size_t
 
 /*===============================================================
 ||                       Public Functions                      ||
@@ -38,17 +39,19 @@ void JoinServer(const int broadcastSocket, int& gameSocket);
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                       ReadDataFromServer                      *
 *------------------------- Description -------------------------*
-* Reads bufferSize bytes from the socket into buffer using TCP  *
+* Reads the next message from the socket into buffer using TCP. *
+* Extra bytes read past the end of the message are kept for the *
+* next call, and a message split across reads is put back       *
+* together.                                                     *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
 *   server about the game. Set up using JoinServer().           *
 *                                                               *
-* char buffer[]: Where the data read from the server will be    *
-*   placed.                                                     *
+* char buffer[]: Where the message read from the server will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
 *                                                               *
-* const int bufferSize: The amount of bytes to read from the    *
-*   server into the buffer.                                     *
+* const int bufferSize: The size of buffer.                     *
 *                                                               *
 *------------------------- Return Value ------------------------*
 * Returns true if the connection to the server is still active. *
@@ -57,10 +60,36 @@ void JoinServer(const int broadcastSocket, int& gameSocket);
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ReadDataFromServer(const int socket, char buffer[], const int bufferSize);
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       ReadDataFromServer                      *
+*------------------------- Description -------------------------*
+* Reads the next message from the socket into buffer, and says  *
+* how long it is. Used for messages that may hold a zero byte.  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   server about the game. Set up using JoinServer().           *
+*                                                               *
+* char buffer[]: Where the message read from the server will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+* int &length: Set to the number of bytes placed in buffer, not *
+*   counting the null.                                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ReadDataFromServer(const int socket, char buffer[], const int bufferSize, int &length);
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        SendDataToServer                       *
 *------------------------- Description -------------------------*
-* Sends data to the socket using a TCP connection.              *
+* Sends data to the socket as one message using a TCP           *
+* connection. The length of the data is sent in front of it.    *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
@@ -75,6 +104,45 @@ bool ReadDataFromServer(const int socket, char buffer[], const int bufferSize);
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool SendDataToServer(const int socket, const char data[]);
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendDataToServer                       *
+*------------------------- Description -------------------------*
+* Sends data of a known length to the socket as one message.    *
+* Used for messages that may hold a zero byte.                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   server about the game. Set up using JoinServer().           *
+*                                                               *
+* const char data[]: The data to send to the server.            *
+*                                                               *
+* const size_t length: The number of bytes of data to send.     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool SendDataToServer(const int socket, const char data[], const size_t length);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       WaitForServerOrUser                     *
+*------------------------- Description -------------------------*
+* Waits until either the server has sent data or the user has   *
+* typed something, whichever is first. Returns right away if a  *
+* whole message from the server has already been read.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   server about the game. Set up using JoinServer().           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the server is ready to be read from, or has   *
+* disconnected. Returns false if the user's input is ready.     *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WaitForServerOrUser(const int socket);
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        CloseConnection                        *
 *------------------------- Description -------------------------*
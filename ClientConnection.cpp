@@ -4,6 +4,476 @@
 #include <stdio.h>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         NextStateItem                         *
+*------------------------- Description -------------------------*
+* Get the next '_' separated item of a state frame.             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string &data: The state frame.                     *
+*                                                               *
+* size_t &start: Where the item starts. Moved past the item.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the item.                                             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+std::string ClientConnection::NextStateItem(const std::string &data, size_t &start)
+{
+    char endOfItem = '_';
+    size_t end = data.find(endOfItem, start);
+    if (end == std::string::npos)
+    {
+        end = data.size();
+    }
+    std::string item = data.substr(start, end - start);
+    start = end + 1;
+    return item;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ReadFullState                         *
+*------------------------- Description -------------------------*
+* Replace knownState with the whole state held in a frame.      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string &data: The state frame.                     *
+*                                                               *
+* size_t start: Where the state starts, after the frame marker. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClientConnection::ReadFullState(const std::string &data, size_t start)
+{
+    // set playerIndex
+    knownState.playerIndex = atoi(NextStateItem(data, start).c_str());
+
+    // set playerTurn
+    knownState.playerTurn = atoi(NextStateItem(data, start).c_str());
+
+    // set newRound
+    knownState.isNewRound = (atoi(NextStateItem(data, start).c_str()) == 1);
+
+    //set player money
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        knownState.playerMoney[i] = atoi(NextStateItem(data, start).c_str());
+    }
+
+    //set player bets
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        knownState.playerBets[i] = atoi(NextStateItem(data, start).c_str());
+    }
+
+    //set player hands
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        int cardCount = atoi(NextStateItem(data, start).c_str());
+        knownState.shownCards[i].clear();
+        for(int j = 0; j < cardCount; j++)
+        {
+            knownState.shownCards[i].push_back(CardCode(NextStateItem(data, start)));
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        ReadStateChanges                       *
+*------------------------- Description -------------------------*
+* Apply the changes held in a frame to knownState.              *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string &data: The state frame.                     *
+*                                                               *
+* size_t start: Where the changes start, after the frame marker.*
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClientConnection::ReadStateChanges(const std::string &data, size_t start)
+{
+    // the turn and new round flag are always sent
+    knownState.playerTurn = atoi(NextStateItem(data, start).c_str());
+    knownState.isNewRound = (atoi(NextStateItem(data, start).c_str()) == 1);
+
+    // each change is a letter and seat, then its values
+    while (start < data.size())
+    {
+        std::string change = NextStateItem(data, start);
+        if (change.empty())
+        {
+            break;
+        }
+        int seat = atoi(change.c_str() + 1);
+        if (seat < 0 || seat > PLAYER_COUNT)
+        {
+            break;
+        }
+        switch (change[0])
+        {
+            // money changed
+            case 'M':
+                knownState.playerMoney[seat] = atoi(NextStateItem(data, start).c_str());
+                break;
+            // bet changed
+            case 'B':
+                knownState.playerBets[seat] = atoi(NextStateItem(data, start).c_str());
+                break;
+            // hand replaced, then cards added
+            case 'H':
+                knownState.shownCards[seat].clear();
+                // fall through
+            case 'C':
+            {
+                int cardCount = atoi(NextStateItem(data, start).c_str());
+                for(int j = 0; j < cardCount; j++)
+                {
+                    knownState.shownCards[seat].push_back(CardCode(NextStateItem(data, start)));
+                }
+                break;
+            }
+            default:
+                return;
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       ReadFullStateCodes                      *
+*------------------------- Description -------------------------*
+* Replace knownState with the whole state held in a protocol 2  *
+* frame, reading each field once in order.                      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char data[]: The state frame.                           *
+*                                                               *
+* const int length: The number of bytes in data.                *
+*                                                               *
+* int at: Where the state starts, after the sequence number.    *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClientConnection::ReadFullStateCodes(const char data[], const int length, int at)
+{
+    // the seat, turn, and new round flag, then the money and bets, are a fixed size
+    if (at + 3 + 2 * (PLAYER_COUNT + 1) * WIRE_INT_SIZE > length)
+    {
+        return;
+    }
+    knownState.playerIndex = (uint8_t) data[at++];
+    knownState.playerTurn = (signed char) data[at++];
+    knownState.isNewRound = (data[at++] == 1);
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        knownState.playerMoney[i] = GetInt32(&data[at]);
+        at += WIRE_INT_SIZE;
+    }
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        knownState.playerBets[i] = GetInt32(&data[at]);
+        at += WIRE_INT_SIZE;
+    }
+
+    //set player hands
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        knownState.shownCards[i].clear();
+        ReadCardCodes(data, length, at, knownState.shownCards[i]);
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      ReadStateChangeCodes                     *
+*------------------------- Description -------------------------*
+* Apply the changes held in a protocol 2 frame to knownState,   *
+* reading each field once in order.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char data[]: The state frame.                           *
+*                                                               *
+* const int length: The number of bytes in data.                *
+*                                                               *
+* int at: Where the changes start, after the sequence number.   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClientConnection::ReadStateChangeCodes(const char data[], const int length, int at)
+{
+    // the turn and new round flag are always sent
+    if (at + 2 > length)
+    {
+        return;
+    }
+    knownState.playerTurn = (signed char) data[at++];
+    knownState.isNewRound = (data[at++] == 1);
+
+    // each change is a code and seat, then its values
+    while (at + 2 <= length)
+    {
+        uint8_t change = data[at++];
+        int seat = (uint8_t) data[at++];
+        if (seat > PLAYER_COUNT)
+        {
+            return;
+        }
+        switch (change)
+        {
+            case MONEY_CHANGED_CODE:
+            case BET_CHANGED_CODE:
+            {
+                if (at + WIRE_INT_SIZE > length)
+                {
+                    return;
+                }
+                int *values = (change == MONEY_CHANGED_CODE) ? knownState.playerMoney : knownState.playerBets;
+                values[seat] = GetInt32(&data[at]);
+                at += WIRE_INT_SIZE;
+                break;
+            }
+            // hand replaced, then cards added
+            case HAND_REPLACED_CODE:
+                knownState.shownCards[seat].clear();
+                // fall through
+            case CARDS_ADDED_CODE:
+                ReadCardCodes(data, length, at, knownState.shownCards[seat]);
+                break;
+            default:
+                return;
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          ReadCardCodes                        *
+*------------------------- Description -------------------------*
+* Add the cards held in a protocol 2 frame to a hand: a card    *
+* count, then a code per card.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char data[]: The state frame.                           *
+*                                                               *
+* const int length: The number of bytes in data.                *
+*                                                               *
+* int &at: Where the cards start. Moved past them.              *
+*                                                               *
+* std::vector<Card> &hand: The hand to add the cards to.        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClientConnection::ReadCardCodes(const char data[], const int length, int &at, std::vector<Card> &hand)
+{
+    if (at >= length)
+    {
+        return;
+    }
+    int cardCount = (uint8_t) data[at++];
+    for(int j = 0; j < cardCount && at < length; j++)
+    {
+        uint8_t code = data[at++];
+        if (code < CARD_RANK_COUNT)
+        {
+            hand.push_back(code);
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           SendRequest                         *
+*------------------------- Description -------------------------*
+* Send a request in the protocol agreed with the server: in     *
+* protocol 1 its word and then its payload as a second message, *
+* in protocol 2 its code and payload as one message.            *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char request[]: The request's protocol 1 word.          *
+*                                                               *
+* const RequestCode code: The request's protocol 2 code.        *
+*                                                               *
+* const char payload[]: What follows the request. nullptr if    *
+*   nothing does.                                               *
+*                                                               *
+* const size_t payloadLength: The number of bytes of payload.   *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::SendRequest(const char request[], const RequestCode code, const char payload[], const size_t payloadLength)
+{
+    if (protocol == PROTOCOL_VERSION)
+    {
+        // built on the stack, and cut short where the server would cut it
+        char message[REQUEST_BUFFER_SIZE];
+        size_t copied = std::min(payloadLength, (size_t) (REQUEST_BUFFER_SIZE - 1));
+        message[0] = code;
+        if (copied > 0)
+        {
+            memcpy(&message[1], payload, copied);
+        }
+        return SendDataToServer(tcpConnection, message, copied + 1);
+    }
+
+    bool hasSucceded = SendDataToServer(tcpConnection, request);
+    if (hasSucceded && payload != nullptr)
+    {
+        hasSucceded = SendDataToServer(tcpConnection, payload, payloadLength);
+    }
+    return hasSucceded;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendNumberRequest                      *
+*------------------------- Description -------------------------*
+* Send a request followed by a number: as text in protocol 1, or*
+* as an integer in protocol 2.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char request[]: The request's protocol 1 word.          *
+*                                                               *
+* const RequestCode code: The request's protocol 2 code.        *
+*                                                               *
+* const int value: The number to send.                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::SendNumberRequest(const char request[], const RequestCode code, const int value)
+{
+    if (protocol == PROTOCOL_VERSION)
+    {
+        char number[WIRE_INT_SIZE];
+        PutInt32(number, value);
+        return SendRequest(request, code, number, WIRE_INT_SIZE);
+    }
+    char str[NUMBER_BUFFER_SIZE];
+    snprintf(str, NUMBER_BUFFER_SIZE, "%d", value);
+    return SendRequest(request, code, str, strlen(str));
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          IsLobbyPush                          *
+*------------------------- Description -------------------------*
+* Check if a message is one the server pushed to subscribers,   *
+* rather than an answer to a request.                           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char message[]: The message read from the server.       *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the message was pushed.                       *
+* Returns false if it was anything else.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::IsLobbyPush(const char message[])
+{
+    size_t markerLength = strlen(LOBBY_EVENTS);
+    return strncmp(message, LOBBY_SNAPSHOT, markerLength) == 0 || strncmp(message, LOBBY_EVENTS, markerLength) == 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          ReadResponse                         *
+*------------------------- Description -------------------------*
+* Read the server's answer to a lobby request, skipping any     *
+* lobby changes pushed ahead of it.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* char buffer[]: Where the answer will be placed. Null          *
+*   terminated, and cut short if it doesn't fit.                *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::ReadResponse(char buffer[], const int bufferSize)
+{
+    do
+    {
+        if (!ReadDataFromServer(tcpConnection, response.data(), LOBBY_MESSAGE_SIZE))
+        {
+            return false;
+        }
+    } while (IsLobbyPush(response.data()));
+
+    strncpy(buffer, response.data(), bufferSize - 1);
+    buffer[bufferSize - 1] = '\0';
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           ReadAnswer                          *
+*------------------------- Description -------------------------*
+* Read the server's answer to a lobby request that is either    *
+* accepted or refused.                                          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* bool &isValid: Set to true if the server accepted it.         *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::ReadAnswer(bool &isValid)
+{
+    char answer[sizeof(SERVER_TRUE) + 1];
+    memset(answer, 0, sizeof(answer));
+    isValid = false;
+    if (!ReadResponse(answer, sizeof(SERVER_TRUE) + 1))
+    {
+        return false;
+    }
+
+    // protocol 2 answers are a single code
+    if (protocol == PROTOCOL_VERSION)
+    {
+        isValid = (answer[0] == (char) SERVER_TRUE_CODE && answer[1] == '\0');
+    }
+    else
+    {
+        isValid = (std::string(answer).compare(std::string(SERVER_TRUE)) == 0);
+    }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       NegotiateProtocol                       *
+*------------------------- Description -------------------------*
+* Ask the server for the newest protocol both sides speak, and  *
+* use it for the rest of the connection. Stays on protocol 1 if *
+* the server gives no answer.                                   *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::NegotiateProtocol()
+{
+    // ask in protocol 1, which every server speaks
+    protocol = 1;
+    std::string version = std::to_string(PROTOCOL_VERSION);
+    bool hasSucceded = SendDataToServer(tcpConnection, PROTOCOL_REQUEST);
+    hasSucceded = hasSucceded && SendDataToServer(tcpConnection, version.c_str());
+    if (!hasSucceded)
+    {
+        return false;
+    }
+
+    char answer[NUMBER_BUFFER_SIZE];
+    if (!ReadResponse(answer, NUMBER_BUFFER_SIZE))
+    {
+        return false;
+    }
+    protocol = std::max(1, std::min(atoi(answer), PROTOCOL_VERSION));
+    return true;
+}
 
 /*===============================================================
 ||                       Public Functions                      ||
@@ -18,9 +488,14 @@
 ClientConnection::ClientConnection()
 {
     tcpConnection = -1;
+    protocol = 1;
     isRegistered = false;
     isInGame = false;
     prevMoney = -1;
+    knownSequence = 0;
+    isResyncing = false;
+    isSubscribed = false;
+    response.resize(LOBBY_MESSAGE_SIZE);
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -48,6 +523,10 @@ void ClientConnection::Register()
     JoinServer(udpSocket, tcpConnection);
     CloseConnection(udpSocket);
     isRegistered = true;
+    knownSequence = 0;
+    isResyncing = false;
+    isSubscribed = false;
+    NegotiateProtocol();
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -76,19 +555,172 @@ bool ClientConnection::ListGames(char* buffer)
 
     bool hasSucceded = true;
     // Ask server for list of games
-    hasSucceded = SendDataToServer(tcpConnection, LIST_GAME_REQUEST);
+    hasSucceded = SendRequest(LIST_GAME_REQUEST, LIST_GAME_CODE, nullptr, 0);
     if (!hasSucceded)
     {
         return false;
     }
 
     // recive list of games from server
-    hasSucceded = ReadDataFromServer(tcpConnection, buffer, LIST_GAME_BUFFER_SIZE);
+    hasSucceded = ReadResponse(buffer, LIST_GAME_BUFFER_SIZE);
+    if (!hasSucceded)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SubscribeToLobby                       *
+*------------------------- Description -------------------------*
+* Request the server to push each change to the available games *
+* until the client joins a game. Use WaitForLobbyChange() to    *
+* find out when to search the games again.                      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::SubscribeToLobby()
+{
+    // auto fail if not connected to server
+    // auto fail if in a game
+    if ((!isRegistered) || isInGame)
+    {
+        return true;
+    }
+
+    bool hasSucceded = true;
+    // Ask server to push the lobby
+    hasSucceded = SendRequest(SUBSCRIBE_REQUEST, SUBSCRIBE_CODE, nullptr, 0);
+    if (!hasSucceded)
+    {
+        return false;
+    }
+
+    // recive the list that starts the subscription, skipping any changes pushed from an earlier one
+    do
+    {
+        hasSucceded = ReadDataFromServer(tcpConnection, response.data(), LOBBY_MESSAGE_SIZE);
+        if (!hasSucceded)
+        {
+            return false;
+        }
+    } while (strncmp(response.data(), LOBBY_SNAPSHOT, strlen(LOBBY_SNAPSHOT)) != 0);
+
+    isSubscribed = true;
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       WaitForLobbyChange                      *
+*------------------------- Description -------------------------*
+* Wait until the server pushes lobby changes or the user types  *
+* something, whichever is first.                                *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* bool &isUserReady: Set to true if the user's input is ready to*
+*   read, false if the lobby changed.                           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::WaitForLobbyChange(bool &isUserReady)
+{
+    // without a subscription nothing is pushed, so only the user can be waited on
+    isUserReady = !isSubscribed || !WaitForServerOrUser(tcpConnection);
+    if (isUserReady)
+    {
+        return true;
+    }
+
+    bool hasSucceded = true;
+    // the changes are only a sign to search again, so they are not kept
+    hasSucceded = ReadDataFromServer(tcpConnection, response.data(), LOBBY_MESSAGE_SIZE);
     if (!hasSucceded)
     {
         return false;
     }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          SearchGames                          *
+*------------------------- Description -------------------------*
+* Request one page of the open games whose names start with a   *
+* prefix, in name order, and recieve it.                        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string prefix: What each name must start with.     *
+*                                                               *
+* const bool freeSeatsOnly: True: Skip games with no free seat. *
+*                                                               *
+* const std::string after: Start after this name. Empty to start*
+*   at the first match, or a page's nextPageAfter for the next. *
+*                                                               *
+* LobbyPage &page: Replaced with the page read from the server. *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::SearchGames(const std::string prefix, const bool freeSeatsOnly, const std::string after, LobbyPage &page)
+{
+    page.names.clear();
+    page.seatsTaken.clear();
+    page.tableIds.clear();
+    page.nextPageAfter = "";
 
+    // auto fail if not connected to server
+    // auto fail if in a game
+    if ((!isRegistered) || isInGame)
+    {
+        return true;
+    }
+
+    bool hasSucceded = true;
+    // Ask server for a page of games
+    std::string search = (freeSeatsOnly ? FREE_SEATS_ONLY : ANY_SEATS) + prefix + "\n" + after;
+    hasSucceded = SendRequest(SEARCH_REQUEST, SEARCH_CODE, search.c_str(), search.size());
+    if (!hasSucceded)
+    {
+        return false;
+    }
+
+    // recive the page: where the next page starts, then a game per line
+    std::vector<char> answer(LOBBY_MESSAGE_SIZE);
+    hasSucceded = ReadResponse(answer.data(), LOBBY_MESSAGE_SIZE);
+    if (!hasSucceded)
+    {
+        return false;
+    }
+    std::string data = answer.data();
+    size_t start = data.find('\n');
+    if (start == std::string::npos)
+    {
+        return true;
+    }
+    page.nextPageAfter = data.substr(0, start);
+    start++;
+    while (start < data.size())
+    {
+        size_t end = data.find('\n', start);
+        size_t idAt = data.find(' ', start);
+        size_t split = (idAt == std::string::npos) ? idAt : data.find(' ', idAt + 1);
+        if (end == std::string::npos || split == std::string::npos || split > end)
+        {
+            break;
+        }
+        page.seatsTaken.push_back(atoi(data.c_str() + start));
+        page.tableIds.push_back(atoi(data.c_str() + idAt + 1));
+        page.names.push_back(data.substr(split + 1, end - split - 1));
+        start = end + 1;
+    }
     return true;
 }
 
@@ -120,16 +752,14 @@ bool ClientConnection::CreateGame(const std::string name)
 
     bool hasSucceded = true;
     // Ask server for to make a game with a name
-    hasSucceded = SendDataToServer(tcpConnection, CREATE_REQUEST);
-    hasSucceded = hasSucceded && SendDataToServer(tcpConnection, name.c_str());
+    hasSucceded = SendRequest(CREATE_REQUEST, CREATE_CODE, name.c_str(), name.size());
     if (!hasSucceded)
     {
         return false;
     }
     // recive response from server
-    char response[sizeof(SERVER_TRUE) + 1];
-
-    hasSucceded = ReadDataFromServer(tcpConnection, response, sizeof(SERVER_TRUE) + 1);
+    bool isValid;
+    hasSucceded = ReadAnswer(isValid);
     if (!hasSucceded)
     {
 
@@ -137,7 +767,7 @@ bool ClientConnection::CreateGame(const std::string name)
     }
 
     // handle server response
-    if (std::string(response).compare(std::string(SERVER_TRUE)) == 0)
+    if (isValid)
     {
         return JoinGame(name);
     }
@@ -168,30 +798,127 @@ bool ClientConnection::JoinGame(const std::string name)
 
     bool hasSucceded = true;
     // Ask server for to join a game with a name
-    hasSucceded = SendDataToServer(tcpConnection, JOIN_REQUEST);
-    hasSucceded = hasSucceded && SendDataToServer(tcpConnection, name.c_str());
+    hasSucceded = SendRequest(JOIN_REQUEST, JOIN_CODE, name.c_str(), name.size());
+    if (!hasSucceded)
+    {
+        return false;
+    }
+
+    // recive response from server
+    bool isValid;
+    hasSucceded = ReadAnswer(isValid);
+    if (!hasSucceded)
+    {
+        return false;
+    }
+
+    // handle server response
+    // joining leaves the lobby, so nothing more is pushed
+    if (isValid)
+    {
+        isInGame = true;
+        isSubscribed = false;
+    }
+    return true;
+
+
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           JoinTable                           *
+*------------------------- Description -------------------------*
+* Request the server to join a game by the table id it was      *
+* listed with.                                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int tableId: The table id of the game to join.          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::JoinTable(const int tableId)
+{
+    // auto fail if not connected to server
+    // auto fail if already in a game
+    if ((!isRegistered) || isInGame)
+    {
+        return true;
+    }
+
+    bool hasSucceded = true;
+    // Ask server to join the game with the table id
+    hasSucceded = SendNumberRequest(JOIN_TABLE_REQUEST, JOIN_TABLE_CODE, tableId);
     if (!hasSucceded)
     {
         return false;
     }
 
     // recive response from server
-    char response[sizeof(SERVER_TRUE) + 1];
-    memset(response, 0, sizeof(response));
-    hasSucceded = ReadDataFromServer(tcpConnection, response, sizeof(SERVER_TRUE) + 1);
+    bool isValid;
+    hasSucceded = ReadAnswer(isValid);
     if (!hasSucceded)
     {
         return false;
     }
 
     // handle server response
-    if (std::string(response).compare(std::string(SERVER_TRUE)) == 0)
+    // joining leaves the lobby, so nothing more is pushed
+    if (isValid)
     {
         isInGame = true;
+        isSubscribed = false;
     }
     return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           QuickJoin                           *
+*------------------------- Description -------------------------*
+* Request the server to seat the client at whichever table has a*
+* seat free next.                                               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* bool &isSeated: Set to true if the client was given a seat.   *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ClientConnection::QuickJoin(bool &isSeated)
+{
+    // auto fail if not connected to server
+    // auto fail if already in a game
+    isSeated = false;
+    if ((!isRegistered) || isInGame)
+    {
+        return true;
+    }
+
+    // Ask server for a seat at any table
+    if (!SendRequest(QUICK_JOIN_REQUEST, QUICK_JOIN_CODE, nullptr, 0))
+    {
+        return false;
+    }
 
+    // recive response from server once it has found a seat
+    bool isValid;
+    if (!ReadAnswer(isValid))
+    {
+        return false;
+    }
 
+    // handle server response
+    // being seated leaves the lobby, so nothing more is pushed
+    if (isValid)
+    {
+        isInGame = true;
+        isSubscribed = false;
+        isSeated = true;
+    }
+    return true;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -203,7 +930,7 @@ bool ClientConnection::JoinGame(const std::string name)
 void ClientConnection::ExitGame()
 {
     // Infrom the server you are leaving the game
-    SendDataToServer(tcpConnection, EXIT_REQUEST);
+    SendRequest(EXIT_REQUEST, EXIT_CODE, nullptr, 0);
     // Clean up local state 
     CloseConnection(tcpConnection);
     tcpConnection = -1;
@@ -220,7 +947,7 @@ void ClientConnection::ExitGame()
 void ClientConnection::Unregister()
 {
     // Infrom the server you are leaving the lobby
-    SendDataToServer(tcpConnection, EXIT_REQUEST);
+    SendRequest(EXIT_REQUEST, EXIT_CODE, nullptr, 0);
     // Clean up local state 
     CloseConnection(tcpConnection);
     tcpConnection = -1;
@@ -252,10 +979,7 @@ bool ClientConnection::Bet(const int val)
 
     bool hasSucceded = true;
     // Ask server to bet an amount
-    char str[BET_BUFFER_SIZE];
-    sprintf(str,"%d", val);
-    hasSucceded = SendDataToServer(tcpConnection, BET_REQUEST);
-    hasSucceded = hasSucceded && SendDataToServer(tcpConnection, str);
+    hasSucceded = SendNumberRequest(BET_REQUEST, BET_CODE, val);
     if (!hasSucceded)
     {
         return false;
@@ -285,7 +1009,7 @@ bool ClientConnection::Hit()
 
     bool hasSucceded = true;
     // Ask server to hit
-    hasSucceded = SendDataToServer(tcpConnection, HIT_REQUEST);
+    hasSucceded = SendRequest(HIT_REQUEST, HIT_CODE, nullptr, 0);
     if (!hasSucceded)
     {
         return false;
@@ -317,7 +1041,7 @@ bool ClientConnection::Stand()
 
     bool hasSucceded = true;
     // Ask server to stand
-    hasSucceded = SendDataToServer(tcpConnection, STAND_REQUEST);
+    hasSucceded = SendRequest(STAND_REQUEST, STAND_CODE, nullptr, 0);
     if (!hasSucceded)
     {
         return false;
@@ -332,6 +1056,11 @@ bool ClientConnection::Stand()
 * Get a state structure from the server that described the      *
 * current state of the game. Pass by refrence due to struct     *
 * using a vector for each player's and the dealer's hands.      *
+* Every STATE_CONFIRM_INTERVAL states, the sequence number read *
+* is confirmed to the server.                                   *
+* Most frames only hold what changed since the last one, so they*
+* are applied to the state built so far. If a frame is missed,  *
+* the whole state is asked for again.                           *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * StateData &state: The state to have the data from the server  *
@@ -344,87 +1073,108 @@ bool ClientConnection::Stand()
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ClientConnection::GetStateData(StateData &state)
 {
-    // read in the data from the server
     bool stillConnected;
     char MultiCharBuffer[FRAME_BUFFER_SIZE];
-    stillConnected = ReadDataFromServer(tcpConnection, MultiCharBuffer, FRAME_BUFFER_SIZE);
-    if (!stillConnected)
+    bool hasNewState = false;
+    while (!hasNewState)
     {
-        return false;
-    }
-    std::string data(MultiCharBuffer);
-    char endOfItem = '_';
-    int start = 0;
-    int end;
-
-    // send conformation of data aquisition;
-    stillConnected = SendDataToServer(tcpConnection, SERVER_TRUE);
-    if (!stillConnected)
-    {
-        return false;
-    }
-
-    // set playerIndex
-    end = data.find(endOfItem, start);
-    state.playerIndex = atoi(data.substr(start, end-start).c_str());
-    start = end + 1;
-    
-    // set playerIndex
-    end = data.find(endOfItem, start);
-    state.playerTurn = atoi(data.substr(start, end-start).c_str());
-    start = end + 1;
-
-    // set newRound
-    end = data.find(endOfItem, start);
-    int temp= atoi(data.substr(start, end-start).c_str());
-    start = end + 1;
-    if(temp == 1)
-    {
-        state.isNewRound = true;
-    }
-    else
-    {
-        state.isNewRound = false;
-    }
-
-    //set player money
-    for(int i = 0; i <= PLAYER_COUNT; i++)
-    {
-        end = data.find(endOfItem, start);
-        state.playerMoney[i] = atoi(data.substr(start, end-start).c_str());
-        start = end + 1;
+        // read in the data from the server
+        int length;
+        stillConnected = ReadDataFromServer(tcpConnection, MultiCharBuffer, FRAME_BUFFER_SIZE, length);
+        if (!stillConnected)
+        {
+            return false;
+        }
+        bool isCoded = (protocol == PROTOCOL_VERSION);
+        std::string data;
+        size_t start = 0;
+        int sequence;
+        bool isFullState;
+        bool isChangedState;
 
-        // set the player last money
-        if (i == state.playerIndex)
+        // read sequence and kind of frame
+        if (isCoded)
         {
-            prevMoney = state.playerMoney[i];
+            if (length < 1 + WIRE_INT_SIZE)
+            {
+                continue;
+            }
+            isFullState = (MultiCharBuffer[0] == (char) FULL_STATE_CODE);
+            isChangedState = (MultiCharBuffer[0] == (char) CHANGED_STATE_CODE);
+            sequence = GetInt32(&MultiCharBuffer[1]);
+            start = 1 + WIRE_INT_SIZE;
+        }
+        else
+        {
+            data = MultiCharBuffer;
+            sequence = atoi(NextStateItem(data, start).c_str());
+            std::string kind = NextStateItem(data, start);
+            isFullState = (kind == FULL_STATE);
+            isChangedState = (kind == CHANGED_STATE);
         }
-    }
 
-    //set player bets
-    for(int i = 0; i <= PLAYER_COUNT; i++)
-    {
-        end = data.find(endOfItem, start);
-        state.playerBets[i] = atoi(data.substr(start, end-start).c_str());
-        start = end + 1;
-    }
+        // confirm states in groups so the server never waits on each one
+        if (sequence % STATE_CONFIRM_INTERVAL == 0)
+        {
+            if (isCoded)
+            {
+                char confirm[1 + WIRE_INT_SIZE];
+                confirm[0] = STATE_CONFIRM_CODE;
+                PutInt32(&confirm[1], sequence);
+                stillConnected = SendDataToServer(tcpConnection, confirm, sizeof(confirm));
+            }
+            else
+            {
+                std::string confirm = STATE_CONFIRM + std::to_string(sequence);
+                stillConnected = SendDataToServer(tcpConnection, confirm.c_str());
+            }
+            if (!stillConnected)
+            {
+                return false;
+            }
+        }
 
-    //set player hands
-    for(int i = 0; i <= PLAYER_COUNT; i++)
-    {
-        end = data.find(endOfItem, start);
-        temp = atoi(data.substr(start, end-start).c_str());
-        start = end + 1;
-        state.shownCards[i].clear();
-        // send each card
-        for(int j = 0; j < temp; j++)
+        if (isFullState)
+        {
+            if (isCoded)
+            {
+                ReadFullStateCodes(MultiCharBuffer, length, start);
+            }
+            else
+            {
+                ReadFullState(data, start);
+            }
+            isResyncing = false;
+            hasNewState = true;
+        }
+        else if (isChangedState && !isResyncing && sequence == knownSequence + 1)
+        {
+            if (isCoded)
+            {
+                ReadStateChangeCodes(MultiCharBuffer, length, start);
+            }
+            else
+            {
+                ReadStateChanges(data, start);
+            }
+            hasNewState = true;
+        }
+        // changes to a state we don't have, ask for the whole state
+        else if (!isResyncing)
         {
-            end = data.find(endOfItem, start);
-            state.shownCards[i].push_back(data.substr(start, end-start).c_str());
-            start = end + 1;
+            stillConnected = SendRequest(STATE_RESYNC, STATE_RESYNC_CODE, nullptr, 0);
+            if (!stillConnected)
+            {
+                return false;
+            }
+            isResyncing = true;
         }
+        knownSequence = sequence;
     }
 
+    // set the player last money
+    state = knownState;
+    prevMoney = state.playerMoney[state.playerIndex];
     return true;
 }
 
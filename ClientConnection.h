@@ -2,6 +2,8 @@
 #define CLIENTCONNECTION_H
 #include <vector>   // vector
 #include <string>   // string
+#include "WireFormat.h"
+#include "Card.h"
 
 /*===============================================================
 ||                       Public Constants                      ||
@@ -27,7 +29,16 @@ struct StateData
     // The bet each player placed (last spot is dealer, unused)
     int playerBets[PLAYER_COUNT + 1];
     // The hand each player and dealer has
-    std::vector<std::string> shownCards[PLAYER_COUNT + 1];
+    std::vector<Card> shownCards[PLAYER_COUNT + 1];
+};
+
+// One page of the open games matching a lobby search
+struct LobbyPage
+{
+    std::vector<std::string> names; // The games on this page, in name order
+    std::vector<int> seatsTaken;    // The players seated in each game
+    std::vector<int> tableIds;      // The table id of each game, used to join it
+    std::string nextPageAfter;      // The name the next page starts after. Empty if this is the last page
 };
 
 // A class that handles the client's connection and game state. 
@@ -41,25 +52,49 @@ class ClientConnection
         ===============================================================*/
         const char* SERVER_TRUE = "TTTTTTTT";       // The response from the server if an action was valid
         const char* SERVER_FALSE = "FFFFFFFF";      // The response from the server if an action was invalid
+        const char* PROTOCOL_REQUEST = "PROTOCOL";  // The client request to speak a newer protocol, followed by the newest it speaks
+        const int REQUEST_BUFFER_SIZE = 1024;       // The most the server reads of any one request
 
         const char* LIST_GAME_REQUEST = "LISTGAME"; // The client request to see all available games
+        const char* SUBSCRIBE_REQUEST = "SUBSCRIB"; // The client request to be pushed changes to the available games
+        const char* LOBBY_SNAPSHOT = "LOBBYSUB";    // Starts the list of games sent after subscribing
+        const char* LOBBY_EVENTS = "LOBBYEVT";      // Starts a message of lobby changes pushed by the server
+        const char GAME_LISTED = '+';               // Starts a lobby line for an open game
+        const char GAME_UNLISTED = '-';             // Starts a lobby line for a game no longer open
+        const char* SEARCH_REQUEST = "SEARCHGM";    // The client request for a page of the open games matching a search
+        const char* FREE_SEATS_ONLY = "F";          // Starts a search for only the games with a seat free
+        const char* ANY_SEATS = "A";                // Starts a search for games whether or not a seat is free
+        const int LOBBY_MESSAGE_SIZE = 65537;       // The largest lobby message the server may send, plus a null
         const char* CREATE_REQUEST = "CREATEGM";    // The client request to create a game
         const char* JOIN_REQUEST = "JOINGAME";      // The client request to join a game
+        const char* JOIN_TABLE_REQUEST = "JOINTBID";// The client request to join a game by its table id
+        const char* QUICK_JOIN_REQUEST = "QUICKJON";// The client request to be seated at whichever table has a seat next
         const char* EXIT_REQUEST = "EXITGAME";      // The client request to be removed from the game
         const char* UNREGISTER_REQUEST = "UNREGIST";// The client request to unregister from the server
         const char* BET_REQUEST = "BET00000";       // The client request to bet
         const char* HIT_REQUEST = "HIT00000";       // The client request to hit
         const char* STAND_REQUEST = "STAND000";     // The client request to stand
+        const char* STATE_CONFIRM = "ACKSTATE";     // Confirms states up to the sequence number that follows
+        const int STATE_CONFIRM_INTERVAL = 4;       // Confirm every this many states instead of each one
+        const char* STATE_RESYNC = "RESYNCST";      // Asks the server to send the whole state again
+        const char* FULL_STATE = "S";               // Marks a state frame holding the whole state
+        const char* CHANGED_STATE = "D";            // Marks a state frame holding only what changed since the last
 
-        const int BET_BUFFER_SIZE = 1024;           // The buffer sized used to convert the client requested money to a character array
+        const int NUMBER_BUFFER_SIZE = 1024;        // The buffer sized used to convert a number sent to the server to a character array
 
         /*===============================================================
         ||                      Private Variables                      ||
         ===============================================================*/
         int tcpConnection;  // The game connection with the server
+        int protocol;       // The protocol version agreed with the server
         bool isRegistered;  // True: Client is connected to server; False: Client is not connected to the server
         bool isInGame;      // True: Client is in a game; False: Client is not in a game
         int prevMoney;      // The last amount of money the client had;
+        StateData knownState;   // The state built from every state frame read so far
+        int knownSequence;      // The sequence number of the last state frame applied to knownState
+        bool isResyncing;       // True: Waiting for the whole state after asking to resync
+        bool isSubscribed;      // True: The server pushes lobby changes; False: The lobby is only seen when asked for
+        std::vector<char> response;         // Where each message from the server is read into while in the lobby
 
         /*===============================================================
         ||                      Private Functions                      ||
@@ -83,6 +118,207 @@ class ClientConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         ClientConnection& operator=(const ClientConnection& other);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         NextStateItem                         *
+        *------------------------- Description -------------------------*
+        * Get the next '_' separated item of a state frame.             *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::string &data: The state frame.                     *
+        *                                                               *
+        * size_t &start: Where the item starts. Moved past the item.    *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the item.                                             *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::string NextStateItem(const std::string &data, size_t &start);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         ReadFullState                         *
+        *------------------------- Description -------------------------*
+        * Replace knownState with the whole state held in a frame.      *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::string &data: The state frame.                     *
+        *                                                               *
+        * size_t start: Where the state starts, after the frame marker. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void ReadFullState(const std::string &data, size_t start);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        ReadStateChanges                       *
+        *------------------------- Description -------------------------*
+        * Apply the changes held in a frame to knownState.              *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::string &data: The state frame.                     *
+        *                                                               *
+        * size_t start: Where the changes start, after the frame marker.*
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void ReadStateChanges(const std::string &data, size_t start);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                       ReadFullStateCodes                      *
+        *------------------------- Description -------------------------*
+        * Replace knownState with the whole state held in a protocol 2  *
+        * frame, reading each field once in order.                      *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const char data[]: The state frame.                           *
+        *                                                               *
+        * const int length: The number of bytes in data.                *
+        *                                                               *
+        * int at: Where the state starts, after the sequence number.    *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void ReadFullStateCodes(const char data[], const int length, int at);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      ReadStateChangeCodes                     *
+        *------------------------- Description -------------------------*
+        * Apply the changes held in a protocol 2 frame to knownState,   *
+        * reading each field once in order.                             *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const char data[]: The state frame.                           *
+        *                                                               *
+        * const int length: The number of bytes in data.                *
+        *                                                               *
+        * int at: Where the changes start, after the sequence number.   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void ReadStateChangeCodes(const char data[], const int length, int at);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          ReadCardCodes                        *
+        *------------------------- Description -------------------------*
+        * Add the cards held in a protocol 2 frame to a hand: a card    *
+        * count, then a code per card.                                  *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const char data[]: The state frame.                           *
+        *                                                               *
+        * const int length: The number of bytes in data.                *
+        *                                                               *
+        * int &at: Where the cards start. Moved past them.              *
+        *                                                               *
+        * std::vector<Card> &hand: The hand to add the cards to.        *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void ReadCardCodes(const char data[], const int length, int &at, std::vector<Card> &hand);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           SendRequest                         *
+        *------------------------- Description -------------------------*
+        * Send a request in the protocol agreed with the server: in     *
+        * protocol 1 its word and then its payload as a second message, *
+        * in protocol 2 its code and payload as one message.            *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const char request[]: The request's protocol 1 word.          *
+        *                                                               *
+        * const RequestCode code: The request's protocol 2 code.        *
+        *                                                               *
+        * const char payload[]: What follows the request. nullptr if    *
+        *   nothing does.                                               *
+        *                                                               *
+        * const size_t payloadLength: The number of bytes of payload.   *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SendRequest(const char request[], const RequestCode code, const char payload[], const size_t payloadLength);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        SendNumberRequest                      *
+        *------------------------- Description -------------------------*
+        * Send a request followed by a number: as text in protocol 1, or*
+        * as an integer in protocol 2.                                  *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const char request[]: The request's protocol 1 word.          *
+        *                                                               *
+        * const RequestCode code: The request's protocol 2 code.        *
+        *                                                               *
+        * const int value: The number to send.                          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SendNumberRequest(const char request[], const RequestCode code, const int value);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          IsLobbyPush                          *
+        *------------------------- Description -------------------------*
+        * Check if a message is one the server pushed to subscribers,   *
+        * rather than an answer to a request.                           *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const char message[]: The message read from the server.       *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the message was pushed.                       *
+        * Returns false if it was anything else.                        *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool IsLobbyPush(const char message[]);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          ReadResponse                         *
+        *------------------------- Description -------------------------*
+        * Read the server's answer to a lobby request, skipping any     *
+        * lobby changes pushed ahead of it.                             *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * char buffer[]: Where the answer will be placed. Null          *
+        *   terminated, and cut short if it doesn't fit.                *
+        *                                                               *
+        * const int bufferSize: The size of buffer.                     *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool ReadResponse(char buffer[], const int bufferSize);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           ReadAnswer                          *
+        *------------------------- Description -------------------------*
+        * Read the server's answer to a lobby request that is either    *
+        * accepted or refused.                                          *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * bool &isValid: Set to true if the server accepted it.         *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool ReadAnswer(bool &isValid);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                       NegotiateProtocol                       *
+        *------------------------- Description -------------------------*
+        * Ask the server for the newest protocol both sides speak, and  *
+        * use it for the rest of the connection. Stays on protocol 1 if *
+        * the server gives no answer.                                   *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool NegotiateProtocol();
+
     public:
         /*===============================================================
         ||                       Public Functions                      ||
@@ -130,6 +366,60 @@ class ClientConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         bool ListGames(char* buffer);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        SubscribeToLobby                       *
+        *------------------------- Description -------------------------*
+        * Request the server to push each change to the available games *
+        * until the client joins a game. Use WaitForLobbyChange() to    *
+        * find out when to search the games again.                      *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SubscribeToLobby();
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                       WaitForLobbyChange                      *
+        *------------------------- Description -------------------------*
+        * Wait until the server pushes lobby changes or the user types  *
+        * something, whichever is first.                                *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * bool &isUserReady: Set to true if the user's input is ready to*
+        *   read, false if the lobby changed.                           *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool WaitForLobbyChange(bool &isUserReady);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          SearchGames                          *
+        *------------------------- Description -------------------------*
+        * Request one page of the open games whose names start with a   *
+        * prefix, in name order, and recieve it.                        *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::string prefix: What each name must start with.     *
+        *                                                               *
+        * const bool freeSeatsOnly: True: Skip games with no free seat. *
+        *                                                               *
+        * const std::string after: Start after this name. Empty to start*
+        *   at the first match, or a page's nextPageAfter for the next. *
+        *                                                               *
+        * LobbyPage &page: Replaced with the page read from the server. *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SearchGames(const std::string prefix, const bool freeSeatsOnly, const std::string after, LobbyPage &page);
+
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                          CreateGame                           *
         *------------------------- Description -------------------------*
@@ -162,6 +452,38 @@ class ClientConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         bool JoinGame(const std::string name);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           JoinTable                           *
+        *------------------------- Description -------------------------*
+        * Request the server to join a game by the table id it was      *
+        * listed with.                                                  *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int tableId: The table id of the game to join.          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool JoinTable(const int tableId);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           QuickJoin                           *
+        *------------------------- Description -------------------------*
+        * Request the server to seat the client at whichever table has a*
+        * seat free next.                                               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * bool &isSeated: Set to true if the client was given a seat.   *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the server is still active. *
+        * Returns false if the connection to the server has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool QuickJoin(bool &isSeated);
+
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                           ExitGame                            *
         *------------------------- Description -------------------------*
@@ -223,6 +545,11 @@ class ClientConnection
         * Get a state structure from the server that described the      *
         * current state of the game. Pass by refrence due to struct     *
         * using a vector for each player's and the dealer's hands.      *
+        * Every STATE_CONFIRM_INTERVAL states, the sequence number read *
+        * is confirmed to the server.                                   *
+        * Most frames only hold what changed since the last one, so they*
+        * are applied to the state built so far. If a frame is missed,  *
+        * the whole state is asked for again.                           *
         *                                                               *
         *------------------------- Parameters --------------------------*
         * StateData &state: The state to have the data from the server  *
@@ -0,0 +1,227 @@
+#ifndef HAND_H
+#define HAND_H
+#include <cstdint>          // uint8_t
+#include <cstring>          // memcmp
+#include "Card.h"           // Card, CardRank, ACE_RANK
+
+/*===============================================================
+||                       Public Constants                      ||
+===============================================================*/
+const int MAX_SAFE_SCORE = 21;  // The highets score before a bust
+// The most cards a hand can hold: every card an ace until the hard total is 21, then one more to bust
+const int MAX_HAND_SIZE = MAX_SAFE_SCORE + 1;
+// The value each rank adds to a hard total, with aces counted as 1
+constexpr uint8_t RANK_VALUES[CARD_RANK_COUNT] = {2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10, 1};
+const int SOFT_ACE_BONUS = 10;  // What an ace adds when it is counted as 11 instead of 1
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// The face up cards of a player or the dealer. The cards are held in place, and
+// the score is kept up to date as each card is added, so reading it never walks
+// the cards or allocates. Copying a hand copies a few dozen bytes.
+class Hand
+{
+    private:
+        /*===============================================================
+        ||                      Private Variables                      ||
+        ===============================================================*/
+        Card cards[MAX_HAND_SIZE] = {}; // The cards, in the order dealt
+        uint8_t count = 0;          // The number of cards held
+        uint8_t hardTotal = 0;      // The total with every ace counted as 1
+        bool hasAce = false;        // True: The hand holds an ace; False: It does not
+        uint8_t score = 0;          // hardTotal, plus SOFT_ACE_BONUS if an ace can count as 11 without busting
+
+    public:
+        /*===============================================================
+        ||                       Public Functions                      ||
+        ===============================================================*/
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Add                              *
+        *------------------------- Description -------------------------*
+        * Add a card to the hand and update its score. Only one ace can *
+        * ever count as 11, so the score only needs the hard total and  *
+        * whether there is an ace. A full hand is left as it is.        *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Card card: The card to add.                             *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void Add(const Card card)
+        {
+            int rank = CardRank(card);
+            if (count >= MAX_HAND_SIZE || rank >= CARD_RANK_COUNT)
+            {
+                return;
+            }
+            cards[count++] = card;
+            hardTotal += RANK_VALUES[rank];
+            hasAce = hasAce || (rank == ACE_RANK);
+            score = hardTotal;
+            if (hasAce && hardTotal + SOFT_ACE_BONUS <= MAX_SAFE_SCORE)
+            {
+                score += SOFT_ACE_BONUS;
+            }
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             Clear                             *
+        *------------------------- Description -------------------------*
+        * Remove every card from the hand.                              *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void Clear()
+        {
+            count = 0;
+            hardTotal = 0;
+            hasAce = false;
+            score = 0;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             Score                             *
+        *------------------------- Description -------------------------*
+        * Get the score of the hand, counting an ace as 11 if that      *
+        * doesn't bust it.                                              *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the score.                                            *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int Score() const
+        {
+            return score;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             IsSoft                            *
+        *------------------------- Description -------------------------*
+        * Check if an ace is counted as 11 in the score.                *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the score holds an ace counted as 11.         *
+        * Returns false if every ace is counted as 1.                   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool IsSoft() const
+        {
+            return score != hardTotal;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             IsBust                            *
+        *------------------------- Description -------------------------*
+        * Check if the hand has gone over MAX_SAFE_SCORE.               *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the hand has busted.                          *
+        * Returns false if it has not.                                  *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool IsBust() const
+        {
+            return score > MAX_SAFE_SCORE;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          IsBlackjack                          *
+        *------------------------- Description -------------------------*
+        * Check if the hand is a blackjack: MAX_SAFE_SCORE in two cards.*
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the hand is a blackjack.                      *
+        * Returns false if it is not.                                   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool IsBlackjack() const
+        {
+            return count == 2 && score == MAX_SAFE_SCORE;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             HasAce                            *
+        *------------------------- Description -------------------------*
+        * Check if the hand holds an ace.                               *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the hand holds an ace.                        *
+        * Returns false if it does not.                                 *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool HasAce() const
+        {
+            return hasAce;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Size                             *
+        *------------------------- Description -------------------------*
+        * Get the number of cards in the hand.                          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the number of cards.                                  *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int Size() const
+        {
+            return count;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             CardAt                            *
+        *------------------------- Description -------------------------*
+        * Get one of the cards in the hand.                             *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int index: The card's place in the hand, from 0 to      *
+        *   Size() - 1.                                                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the card.                                             *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        Card CardAt(const int index) const
+        {
+            return cards[index];
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           StartsWith                          *
+        *------------------------- Description -------------------------*
+        * Check if this hand is another hand with more cards added.     *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Hand &other: The hand to compare against.               *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if other's cards start this hand.                *
+        * Returns false if they do not.                                 *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool StartsWith(const Hand &other) const
+        {
+            return other.count <= count && memcmp(cards, other.cards, other.count) == 0;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           operator==                          *
+        *------------------------- Description -------------------------*
+        * Check if two hands hold the same cards in the same order.     *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Hand &other: The hand to compare against.               *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the hands match.                              *
+        * Returns false if they do not.                                 *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool operator==(const Hand &other) const
+        {
+            return count == other.count && StartsWith(other);
+        }
+};
+
+#endif
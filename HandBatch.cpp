@@ -0,0 +1,243 @@
+#include "HandBatch.h"
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAND_BATCH_HAS_X86
+#endif
+
+//function headers
+int ScoreHandsScalar(const HandColumns &hands, HandScores &scores, const int first);
+#ifdef HAND_BATCH_HAS_X86
+int ScoreHandsSse(const HandColumns &hands, HandScores &scores, const int first);
+int ScoreHandsAvx2(const HandColumns &hands, HandScores &scores, const int first);
+#endif
+
+/*===============================================================
+||                          Constants                          ||
+===============================================================*/
+const int SSE_LANES = 16;   // The hands scored per SSE instruction
+const int AVX2_LANES = 32;  // The hands scored per AVX2 instruction
+
+// RANK_VALUES spread over the 16 ranks a card's low bits can hold, so a byte shuffle
+// looks up 16 cards at once. The ranks past the last card, including NO_CARD's, are worth 0
+constexpr std::array<uint8_t, SSE_LANES> MakeValueLanes()
+{
+    std::array<uint8_t, SSE_LANES> lanes{};
+    for (int rank = 0; rank < CARD_RANK_COUNT; rank++)
+    {
+        lanes[rank] = RANK_VALUES[rank];
+    }
+    return lanes;
+}
+alignas(SSE_LANES) constexpr std::array<uint8_t, SSE_LANES> RANK_VALUE_LANES = MakeValueLanes();
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ScoreHandBatch                        *
+*------------------------- Description -------------------------*
+* Score every hand in a block using the widest instructions     *
+* this CPU has, up to widest.                                   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandColumns &hands: The hands to score.                 *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+* const BatchWidth widest: The widest instructions to use.      *
+*   SCALAR_BATCH scores every hand one at a time.               *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the widest instructions used.                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+BatchWidth ScoreHandBatch(const HandColumns &hands, HandScores &scores, const BatchWidth widest)
+{
+    // each width scores the whole blocks it can, and leaves the rest to the next
+    BatchWidth used = SCALAR_BATCH;
+    int scored = 0;
+#ifdef HAND_BATCH_HAS_X86
+    if (widest >= AVX2_BATCH && __builtin_cpu_supports("avx2"))
+    {
+        scored = ScoreHandsAvx2(hands, scores, scored);
+        used = AVX2_BATCH;
+    }
+    if (widest >= SSE_BATCH && __builtin_cpu_supports("ssse3"))
+    {
+        scored = ScoreHandsSse(hands, scores, scored);
+        if (used == SCALAR_BATCH)
+        {
+            used = SSE_BATCH;
+        }
+    }
+#endif
+    ScoreHandsScalar(hands, scores, scored);
+    return used;
+}
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        ScoreHandsScalar                       *
+*------------------------- Description -------------------------*
+* Score the hands from first on one at a time, by dealing each  *
+* into a Hand.                                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandColumns &hands: The hands to score.                 *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+* const int first: The first hand to score.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of hands scored so far, which is all of    *
+* them.                                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ScoreHandsScalar(const HandColumns &hands, HandScores &scores, const int first)
+{
+    for (int h = first; h < hands.handCount; h++)
+    {
+        Hand hand;
+        for (int c = 0; c < hands.cardCount; c++)
+        {
+            hand.Add(hands.cards[c][h]);
+        }
+        scores.totals[h] = hand.Score();
+        scores.isSoft[h] = hand.IsSoft();
+        scores.isBust[h] = hand.IsBust();
+        scores.isBlackjack[h] = hand.IsBlackjack();
+    }
+    return hands.handCount;
+}
+
+#ifdef HAND_BATCH_HAS_X86
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          ScoreHandsSse                        *
+*------------------------- Description -------------------------*
+* Score the hands from first on SSE_LANES at a time, using the  *
+* same rules as Hand::Add() on every lane. Built for SSSE3 so   *
+* the rest of the program doesn't need it.                      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandColumns &hands: The hands to score.                 *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+* const int first: The first hand to score.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of hands scored so far. Fewer than         *
+* SSE_LANES hands are left for a narrower width.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+__attribute__((target("ssse3")))
+int ScoreHandsSse(const HandColumns &hands, HandScores &scores, const int first)
+{
+    const __m128i valueTable = _mm_load_si128((const __m128i*) RANK_VALUE_LANES.data());
+    const __m128i rankMask = _mm_set1_epi8(CARD_RANK_MASK);
+    const __m128i aceRank = _mm_set1_epi8(ACE_RANK);
+    const __m128i softLimit = _mm_set1_epi8(MAX_SAFE_SCORE - SOFT_ACE_BONUS);
+    const __m128i softBonus = _mm_set1_epi8(SOFT_ACE_BONUS);
+    const __m128i safeScore = _mm_set1_epi8(MAX_SAFE_SCORE);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+
+    int h = first;
+    for (; h + SSE_LANES <= hands.handCount; h += SSE_LANES)
+    {
+        __m128i hardTotal = zero;
+        __m128i hasAce = zero;
+        __m128i cardsHeld = zero;
+        for (int c = 0; c < hands.cardCount; c++)
+        {
+            // NO_CARD's rank is past the last card, so it adds nothing
+            __m128i ranks = _mm_and_si128(_mm_loadu_si128((const __m128i*) &hands.cards[c][h]), rankMask);
+            __m128i values = _mm_shuffle_epi8(valueTable, ranks);
+            hardTotal = _mm_add_epi8(hardTotal, values);
+            hasAce = _mm_or_si128(hasAce, _mm_cmpeq_epi8(ranks, aceRank));
+            cardsHeld = _mm_add_epi8(cardsHeld, _mm_andnot_si128(_mm_cmpeq_epi8(values, zero), one));
+        }
+
+        // an ace counts as 11 if the hard total is at most MAX_SAFE_SCORE - SOFT_ACE_BONUS
+        __m128i isSoft = _mm_and_si128(hasAce, _mm_cmpeq_epi8(_mm_min_epu8(hardTotal, softLimit), hardTotal));
+        __m128i score = _mm_add_epi8(hardTotal, _mm_and_si128(isSoft, softBonus));
+        __m128i isSafe = _mm_cmpeq_epi8(_mm_min_epu8(score, safeScore), score);
+        __m128i isBlackjack = _mm_and_si128(_mm_cmpeq_epi8(cardsHeld, two), _mm_cmpeq_epi8(score, safeScore));
+
+        _mm_storeu_si128((__m128i*) &scores.totals[h], score);
+        _mm_storeu_si128((__m128i*) &scores.isSoft[h], _mm_and_si128(isSoft, one));
+        _mm_storeu_si128((__m128i*) &scores.isBust[h], _mm_andnot_si128(isSafe, one));
+        _mm_storeu_si128((__m128i*) &scores.isBlackjack[h], _mm_and_si128(isBlackjack, one));
+    }
+    return h;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ScoreHandsAvx2                        *
+*------------------------- Description -------------------------*
+* Score the hands from first on AVX2_LANES at a time, the same  *
+* way as ScoreHandsSse(). Built for AVX2 so the rest of the     *
+* program doesn't need it.                                      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandColumns &hands: The hands to score.                 *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+* const int first: The first hand to score.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of hands scored so far. Fewer than         *
+* AVX2_LANES hands are left for a narrower width.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+__attribute__((target("avx2")))
+int ScoreHandsAvx2(const HandColumns &hands, HandScores &scores, const int first)
+{
+    // the byte shuffle looks up within each half, so both halves get the table
+    const __m256i valueTable = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) RANK_VALUE_LANES.data()));
+    const __m256i rankMask = _mm256_set1_epi8(CARD_RANK_MASK);
+    const __m256i aceRank = _mm256_set1_epi8(ACE_RANK);
+    const __m256i softLimit = _mm256_set1_epi8(MAX_SAFE_SCORE - SOFT_ACE_BONUS);
+    const __m256i softBonus = _mm256_set1_epi8(SOFT_ACE_BONUS);
+    const __m256i safeScore = _mm256_set1_epi8(MAX_SAFE_SCORE);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+
+    int h = first;
+    for (; h + AVX2_LANES <= hands.handCount; h += AVX2_LANES)
+    {
+        __m256i hardTotal = zero;
+        __m256i hasAce = zero;
+        __m256i cardsHeld = zero;
+        for (int c = 0; c < hands.cardCount; c++)
+        {
+            __m256i ranks = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) &hands.cards[c][h]), rankMask);
+            __m256i values = _mm256_shuffle_epi8(valueTable, ranks);
+            hardTotal = _mm256_add_epi8(hardTotal, values);
+            hasAce = _mm256_or_si256(hasAce, _mm256_cmpeq_epi8(ranks, aceRank));
+            cardsHeld = _mm256_add_epi8(cardsHeld, _mm256_andnot_si256(_mm256_cmpeq_epi8(values, zero), one));
+        }
+
+        __m256i isSoft = _mm256_and_si256(hasAce, _mm256_cmpeq_epi8(_mm256_min_epu8(hardTotal, softLimit), hardTotal));
+        __m256i score = _mm256_add_epi8(hardTotal, _mm256_and_si256(isSoft, softBonus));
+        __m256i isSafe = _mm256_cmpeq_epi8(_mm256_min_epu8(score, safeScore), score);
+        __m256i isBlackjack = _mm256_and_si256(_mm256_cmpeq_epi8(cardsHeld, two), _mm256_cmpeq_epi8(score, safeScore));
+
+        _mm256_storeu_si256((__m256i*) &scores.totals[h], score);
+        _mm256_storeu_si256((__m256i*) &scores.isSoft[h], _mm256_and_si256(isSoft, one));
+        _mm256_storeu_si256((__m256i*) &scores.isBust[h], _mm256_andnot_si256(isSafe, one));
+        _mm256_storeu_si256((__m256i*) &scores.isBlackjack[h], _mm256_and_si256(isBlackjack, one));
+    }
+    return h;
+}
+#endif
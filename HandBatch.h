@@ -0,0 +1,61 @@
+#ifndef HANDBATCH_H
+#define HANDBATCH_H
+#include <cstdint>          // uint8_t
+#include "Hand.h"           // Card, MAX_HAND_SIZE
+
+// Scores many hands at once for simulations and offline analysis. Hands are laid
+// out a card at a time, so the first card of every hand is in one column, the
+// second card in the next, and so on. That lets one vector instruction work on
+// the same card of 32 hands (AVX2) or 16 hands (SSE), with hands left over scored
+// one at a time through Hand. Each hand scores the same as it would as a Hand.
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// The widest instructions ScoreHandBatch() may use
+enum BatchWidth {SCALAR_BATCH, SSE_BATCH, AVX2_BATCH};
+
+// A block of hands to score, a column per card
+struct HandColumns
+{
+    // cards[i][h] is card i of hand h. Hands with fewer cards are padded with NO_CARD
+    const Card *cards[MAX_HAND_SIZE];
+    int cardCount = 0;      // The number of columns in cards
+    int handCount = 0;      // The number of hands, and so the length of each column
+};
+
+// Where ScoreHandBatch() writes each hand's results. Each array holds handCount values
+struct HandScores
+{
+    uint8_t *totals = nullptr;      // The score of each hand, as Hand::Score()
+    uint8_t *isSoft = nullptr;      // 1: An ace is counted as 11; 0: Every ace is counted as 1
+    uint8_t *isBust = nullptr;      // 1: The hand has gone over MAX_SAFE_SCORE; 0: It has not
+    uint8_t *isBlackjack = nullptr; // 1: The hand is MAX_SAFE_SCORE in two cards; 0: It is not
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ScoreHandBatch                        *
+*------------------------- Description -------------------------*
+* Score every hand in a block using the widest instructions     *
+* this CPU has, up to widest.                                   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandColumns &hands: The hands to score.                 *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+* const BatchWidth widest: The widest instructions to use.      *
+*   SCALAR_BATCH scores every hand one at a time.               *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the widest instructions used.                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+BatchWidth ScoreHandBatch(const HandColumns &hands, HandScores &scores, const BatchWidth widest);
+
+#endif
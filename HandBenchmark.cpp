@@ -0,0 +1,258 @@
+#include "HandBatch.h"
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <vector>
+
+//function headers
+int DealHands(std::vector<Card> &rows, std::vector<Card> &columns);
+double TimePerHand(const std::vector<Card> &rows, HandScores &scores);
+double TimeBatch(const HandColumns &hands, HandScores &scores, const BatchWidth widest, BatchWidth &used);
+bool SameScores(const HandScores &expected, const HandScores &actual);
+
+/*===============================================================
+||                          Constants                          ||
+===============================================================*/
+const int HAND_COUNT = 1 << 20;     // The number of hands scored in each run
+const int RUN_COUNT = 20;           // The runs timed for each method, keeping the fastest
+const int BENCHMARK_DECKS = 8;      // The decks in the shoe the hands are dealt from
+const int DEALER_STAND_ON = 17;     // Each hand is dealt to until it reaches this, like the dealer's
+const unsigned int HAND_SEED = 2928;// Seeds the shuffles, so every run scores the same hands
+// The name each width is printed as
+const char* const BATCH_WIDTH_NAMES[] = {"batch scalar", "batch SSE", "batch AVX2"};
+
+// One set of results per method, so each can be checked against per hand scoring
+struct ScoreArrays
+{
+    std::vector<uint8_t> totals = std::vector<uint8_t>(HAND_COUNT);
+    std::vector<uint8_t> isSoft = std::vector<uint8_t>(HAND_COUNT);
+    std::vector<uint8_t> isBust = std::vector<uint8_t>(HAND_COUNT);
+    std::vector<uint8_t> isBlackjack = std::vector<uint8_t>(HAND_COUNT);
+
+    // Where ScoreHandBatch() writes into these arrays
+    HandScores View()
+    {
+        HandScores scores;
+        scores.totals = totals.data();
+        scores.isSoft = isSoft.data();
+        scores.isBust = isBust.data();
+        scores.isBlackjack = isBlackjack.data();
+        return scores;
+    }
+};
+
+/*===============================================================
+||                            Main                             ||
+===============================================================*/
+
+// Measures how many hands a second are scored one at a time through Hand, the
+// way the tables score them, against scoring the same hands as a batch at each
+// width this CPU has. Every method's results are checked against per hand scoring.
+int main()
+{
+    // the same hands, a hand per row and a card per column
+    std::vector<Card> rows;
+    std::vector<Card> columns;
+    HandColumns hands;
+    hands.handCount = HAND_COUNT;
+    hands.cardCount = DealHands(rows, columns);
+    for (int c = 0; c < hands.cardCount; c++)
+    {
+        hands.cards[c] = &columns[(size_t) c * HAND_COUNT];
+    }
+
+    ScoreArrays perHand;
+    HandScores perHandScores = perHand.View();
+    double perHandTime = TimePerHand(rows, perHandScores);
+
+    std::cout << HAND_COUNT << " hands of up to " << hands.cardCount << " cards" << std::endl;
+    std::cout << std::setw(14) << "method" << std::setw(14) << "ns/hand"
+              << std::setw(14) << "Mhands/s" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(2) << std::setw(14) << "per hand"
+              << std::setw(14) << perHandTime * 1e9 / HAND_COUNT
+              << std::setw(14) << HAND_COUNT / perHandTime / 1e6 << std::setw(10) << 1.0 << std::endl;
+
+    for (BatchWidth widest : {SCALAR_BATCH, SSE_BATCH, AVX2_BATCH})
+    {
+        ScoreArrays batch;
+        HandScores batchScores = batch.View();
+        BatchWidth used;
+        double batchTime = TimeBatch(hands, batchScores, widest, used);
+
+        // a width this CPU doesn't have falls back to one already printed
+        if (used != widest)
+        {
+            std::cout << std::setw(14) << BATCH_WIDTH_NAMES[widest] << "  not supported" << std::endl;
+            continue;
+        }
+        if (!SameScores(perHandScores, batchScores))
+        {
+            std::cout << BATCH_WIDTH_NAMES[widest] << " scored a hand differently from Hand" << std::endl;
+            return 1;
+        }
+        std::cout << std::setw(14) << BATCH_WIDTH_NAMES[widest]
+                  << std::setw(14) << batchTime * 1e9 / HAND_COUNT
+                  << std::setw(14) << HAND_COUNT / batchTime / 1e6
+                  << std::setw(10) << perHandTime / batchTime << std::endl;
+    }
+    return 0;
+}
+
+/*===============================================================
+||                      Helper Functions                       ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           DealHands                           *
+*------------------------- Description -------------------------*
+* Deal HAND_COUNT hands from shuffled shoes, each dealt to until*
+* it reaches DEALER_STAND_ON like the dealer's. A shoe is       *
+* reshuffled once half of it is used.                           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* std::vector<Card> &rows: Filled with MAX_HAND_SIZE cards per  *
+*   hand, padded with NO_CARD.                                  *
+*                                                               *
+* std::vector<Card> &columns: Filled with the same hands a card *
+*   at a time: HAND_COUNT first cards, then HAND_COUNT second   *
+*   cards, and so on.                                           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the most cards in any hand, and so the columns used.  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int DealHands(std::vector<Card> &rows, std::vector<Card> &columns)
+{
+    std::mt19937 generator(HAND_SEED);
+    std::array<Card, BENCHMARK_DECKS * CARDS_IN_STANDARD_DECK> shoe = MakeShoe<BENCHMARK_DECKS>();
+    std::shuffle(shoe.begin(), shoe.end(), generator);
+    size_t next = 0;
+
+    rows.assign((size_t) HAND_COUNT * MAX_HAND_SIZE, NO_CARD);
+    columns.assign((size_t) HAND_COUNT * MAX_HAND_SIZE, NO_CARD);
+    int longestHand = 0;
+    for (int h = 0; h < HAND_COUNT; h++)
+    {
+        Hand hand;
+        while (hand.Score() < DEALER_STAND_ON)
+        {
+            if (next >= shoe.size() / 2)
+            {
+                std::shuffle(shoe.begin(), shoe.end(), generator);
+                next = 0;
+            }
+            Card card = shoe[next++];
+            rows[(size_t) h * MAX_HAND_SIZE + hand.Size()] = card;
+            columns[(size_t) hand.Size() * HAND_COUNT + h] = card;
+            hand.Add(card);
+        }
+        longestHand = std::max(longestHand, hand.Size());
+    }
+    return longestHand;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          TimePerHand                          *
+*------------------------- Description -------------------------*
+* Time scoring every hand one at a time, by dealing its row into*
+* a Hand as a table would.                                      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::vector<Card> &rows: The hands, MAX_HAND_SIZE cards *
+*   per hand.                                                   *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the fastest run, in seconds.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+double TimePerHand(const std::vector<Card> &rows, HandScores &scores)
+{
+    double fastest = 0;
+    for (int run = 0; run < RUN_COUNT; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int h = 0; h < HAND_COUNT; h++)
+        {
+            const Card *row = &rows[(size_t) h * MAX_HAND_SIZE];
+            Hand hand;
+            for (int c = 0; c < MAX_HAND_SIZE && row[c] != NO_CARD; c++)
+            {
+                hand.Add(row[c]);
+            }
+            scores.totals[h] = hand.Score();
+            scores.isSoft[h] = hand.IsSoft();
+            scores.isBust[h] = hand.IsBust();
+            scores.isBlackjack[h] = hand.IsBlackjack();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (run == 0 || seconds < fastest)
+        {
+            fastest = seconds;
+        }
+    }
+    return fastest;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           TimeBatch                           *
+*------------------------- Description -------------------------*
+* Time scoring every hand with ScoreHandBatch().                *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandColumns &hands: The hands to score.                 *
+*                                                               *
+* HandScores &scores: Where the results are written.            *
+*                                                               *
+* const BatchWidth widest: The widest instructions to use.      *
+*                                                               *
+* BatchWidth &used: Set to the widest instructions used.        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the fastest run, in seconds.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+double TimeBatch(const HandColumns &hands, HandScores &scores, const BatchWidth widest, BatchWidth &used)
+{
+    double fastest = 0;
+    for (int run = 0; run < RUN_COUNT; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        used = ScoreHandBatch(hands, scores, widest);
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (run == 0 || seconds < fastest)
+        {
+            fastest = seconds;
+        }
+    }
+    return fastest;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          SameScores                           *
+*------------------------- Description -------------------------*
+* Check two methods gave every hand the same results.           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const HandScores &expected: The results to match.             *
+*                                                               *
+* const HandScores &actual: The results to check.               *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if every result matches.                         *
+* Returns false if any differ.                                  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool SameScores(const HandScores &expected, const HandScores &actual)
+{
+    return memcmp(expected.totals, actual.totals, HAND_COUNT) == 0
+        && memcmp(expected.isSoft, actual.isSoft, HAND_COUNT) == 0
+        && memcmp(expected.isBust, actual.isBust, HAND_COUNT) == 0
+        && memcmp(expected.isBlackjack, actual.isBlackjack, HAND_COUNT) == 0;
+}
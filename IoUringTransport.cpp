@@ -0,0 +1,307 @@
+#include "IoUringTransport.h" // My H file
+#include <linux/io_uring.h> // io_uring_params, io_uring_sqe, io_uring_cqe
+#include <sys/syscall.h>    // __NR_io_uring_setup, __NR_io_uring_enter
+#include <sys/mman.h>       // mmap, munmap
+#include <sys/socket.h>     // MSG_NOSIGNAL
+#include <unistd.h>         // syscall, close
+#include <cerrno>           // errno, EINTR
+#include <cstring>          // memset
+
+/*===============================================================
+||                      Private Constants                      ||
+===============================================================*/
+const unsigned int RING_ENTRIES = 64;   // The most requests in flight on one thread's ring
+
+/*===============================================================
+||                      Private Data Types                     ||
+===============================================================*/
+
+// The shared memory and file descriptor of one thread's io_uring
+struct IoRing
+{
+    int ringFd = -1;                // The ring returned by io_uring_setup()
+    bool isBroken = false;          // True: setup failed on this thread, don't retry
+
+    void* sqMemory = nullptr;       // The mapped submission queue ring
+    size_t sqMemorySize = 0;
+    void* cqMemory = nullptr;       // The mapped completion queue ring (may equal sqMemory)
+    size_t cqMemorySize = 0;
+    io_uring_sqe* sqes = nullptr;   // The mapped submission queue entries
+    size_t sqesSize = 0;
+
+    unsigned int* sqHead = nullptr;
+    unsigned int* sqTail = nullptr;
+    unsigned int* sqMask = nullptr;
+    unsigned int* sqArray = nullptr;
+    unsigned int* cqHead = nullptr;
+    unsigned int* cqTail = nullptr;
+    unsigned int* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    ~IoRing()
+    {
+        if (sqes != nullptr)
+        {
+            munmap(sqes, sqesSize);
+        }
+        if (cqMemory != nullptr && cqMemory != sqMemory)
+        {
+            munmap(cqMemory, cqMemorySize);
+        }
+        if (sqMemory != nullptr)
+        {
+            munmap(sqMemory, sqMemorySize);
+        }
+        if (ringFd >= 0)
+        {
+            close(ringFd);
+        }
+    }
+};
+
+// The ring owned by the calling thread
+thread_local IoRing threadRing;
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          EnterRing                            *
+*------------------------- Description -------------------------*
+* Submits toSubmit entries and waits for minComplete            *
+* completions, retrying if interrupted by a signal.             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* IoRing &ring: The ring to enter.                              *
+*                                                               *
+* const unsigned int toSubmit: The new entries to submit.       *
+*                                                               *
+* const unsigned int minComplete: The completions to wait for.  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the kernel accepted the submission.           *
+* Returns false if io_uring_enter() failed.                     *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool EnterRing(IoRing &ring, const unsigned int toSubmit, const unsigned int minComplete)
+{
+    unsigned int left = toSubmit;
+    while (true)
+    {
+        long submitted = syscall(__NR_io_uring_enter, ring.ringFd, left, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (submitted >= 0)
+        {
+            return true;
+        }
+        if (errno != EINTR)
+        {
+            return false;
+        }
+        // entries were consumed before the signal; only wait from here on
+        left = 0;
+    }
+}
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          StartIoRing                          *
+*------------------------- Description -------------------------*
+* Sets up an io_uring for the calling thread using the raw      *
+* system calls. Each thread gets its own ring so submissions    *
+* never need a lock. Calling it again on the same thread does   *
+* nothing.                                                      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the calling thread has a working ring.        *
+* Returns false if io_uring is not available on this host.      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool StartIoRing()
+{
+    IoRing &ring = threadRing;
+    if (ring.ringFd >= 0)
+    {
+        return true;
+    }
+    if (ring.isBroken)
+    {
+        return false;
+    }
+    ring.isBroken = true;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ringFd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    if (ringFd < 0)
+    {
+        return false;
+    }
+    ring.ringFd = ringFd;
+
+    // map the submission and completion rings (one mapping on newer kernels)
+    ring.sqMemorySize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring.cqMemorySize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap && ring.cqMemorySize > ring.sqMemorySize)
+    {
+        ring.sqMemorySize = ring.cqMemorySize;
+    }
+    void* sqMemory = mmap(nullptr, ring.sqMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqMemory == MAP_FAILED)
+    {
+        return false;
+    }
+    ring.sqMemory = sqMemory;
+
+    if (singleMap)
+    {
+        ring.cqMemory = sqMemory;
+    }
+    else
+    {
+        void* cqMemory = mmap(nullptr, ring.cqMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqMemory == MAP_FAILED)
+        {
+            return false;
+        }
+        ring.cqMemory = cqMemory;
+    }
+
+    ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        return false;
+    }
+    ring.sqes = (io_uring_sqe*) sqes;
+
+    char* sq = (char*) ring.sqMemory;
+    ring.sqHead = (unsigned int*) (sq + params.sq_off.head);
+    ring.sqTail = (unsigned int*) (sq + params.sq_off.tail);
+    ring.sqMask = (unsigned int*) (sq + params.sq_off.ring_mask);
+    ring.sqArray = (unsigned int*) (sq + params.sq_off.array);
+    char* cq = (char*) ring.cqMemory;
+    ring.cqHead = (unsigned int*) (cq + params.cq_off.head);
+    ring.cqTail = (unsigned int*) (cq + params.cq_off.tail);
+    ring.cqMask = (unsigned int*) (cq + params.cq_off.ring_mask);
+    ring.cqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+
+    ring.isBroken = false;
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        RunRingRequests                        *
+*------------------------- Description -------------------------*
+* Submits every request to the calling thread's ring with as few*
+* io_uring_enter() calls as the ring size allows, then waits    *
+* until all of them complete. Each request's result is filled   *
+* in like the return value of read() or write(). If the ring    *
+* stops taking requests, the ones it never took get -errno.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* RingRequest requests[]: The reads and writes to run.          *
+*                                                               *
+* const int count: The number of requests.                      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the requests ran on the ring.                 *
+* Returns false if the thread has no ring, in which case none of*
+* the requests were run.                                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool RunRingRequests(RingRequest requests[], const int count)
+{
+    IoRing &ring = threadRing;
+    if (ring.ringFd < 0)
+    {
+        return false;
+    }
+
+    int next = 0;
+    while (next < count)
+    {
+        // queue as many requests as fit in the ring
+        unsigned int batch = 0;
+        const unsigned int batchStart = *ring.sqTail;
+        unsigned int tail = batchStart;
+        while ((next + (int) batch < count) && (batch < RING_ENTRIES))
+        {
+            RingRequest &request = requests[next + batch];
+            unsigned int index = tail & *ring.sqMask;
+            io_uring_sqe* sqe = &ring.sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->fd = request.socket;
+            if (request.parts != nullptr)
+            {
+                // gathered write, sent as one message
+                memset(&request.message, 0, sizeof(request.message));
+                request.message.msg_iov = request.parts;
+                request.message.msg_iovlen = request.partCount;
+                sqe->opcode = IORING_OP_SENDMSG;
+                sqe->addr = (unsigned long) &request.message;
+                sqe->len = 1;
+            }
+            else
+            {
+                sqe->opcode = request.isRead ? IORING_OP_RECV : IORING_OP_SEND;
+                sqe->addr = (unsigned long) request.buffer;
+                sqe->len = request.length;
+            }
+            sqe->msg_flags = request.isRead ? 0 : MSG_NOSIGNAL;
+            sqe->user_data = next + batch;
+            ring.sqArray[index] = index;
+            tail++;
+            batch++;
+        }
+        __atomic_store_n(ring.sqTail, tail, __ATOMIC_RELEASE);
+
+        // submit the batch with one system call and wait for all of it
+        bool hasFailed = !EnterRing(ring, batch, batch);
+        if (hasFailed)
+        {
+            // take back the entries the kernel never read, so none are left in the ring
+            // pointing at requests that are about to go away. The ones it read are still
+            // reaped below, and nothing after them is run
+            int error = errno;
+            unsigned int taken = __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE) - batchStart;
+            __atomic_store_n(ring.sqTail, batchStart + taken, __ATOMIC_RELEASE);
+            for (int i = next + taken; i < count; i++)
+            {
+                requests[i].result = -error;
+            }
+            batch = taken;
+        }
+
+        // reap completions until the whole batch is back
+        unsigned int reaped = 0;
+        while (reaped < batch)
+        {
+            unsigned int head = *ring.cqHead;
+            unsigned int cqTail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+            if (head == cqTail)
+            {
+                EnterRing(ring, 0, 1);
+                continue;
+            }
+            while (head != cqTail)
+            {
+                io_uring_cqe* cqe = &ring.cqes[head & *ring.cqMask];
+                requests[cqe->user_data].result = cqe->res;
+                head++;
+                reaped++;
+            }
+            __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+        }
+        if (hasFailed)
+        {
+            return true;
+        }
+        next += batch;
+    }
+    return true;
+}
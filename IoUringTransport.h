@@ -0,0 +1,64 @@
+#ifndef IOURINGTRANSPORT_H
+#define IOURINGTRANSPORT_H
+#include <sys/socket.h>     // msghdr
+#include <sys/uio.h>        // iovec
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// One read or write to run on a thread's io_uring
+struct RingRequest
+{
+    int socket = -1;            // The socket to read from or write to
+    bool isRead = false;        // True: read into buffer; False: write from buffer
+    void* buffer = nullptr;     // Where to read into or write from
+    unsigned int length = 0;    // The number of bytes to read or write
+    iovec* parts = nullptr;     // If set, the pieces to write in order instead of buffer
+    int partCount = 0;          // The number of pieces in parts
+    long result = 0;            // Bytes moved, or a negative errno once complete
+    msghdr message;             // Used by the ring while a gathered write is in flight
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          StartIoRing                          *
+*------------------------- Description -------------------------*
+* Sets up an io_uring for the calling thread using the raw      *
+* system calls. Each thread gets its own ring so submissions    *
+* never need a lock. Calling it again on the same thread does   *
+* nothing.                                                      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the calling thread has a working ring.        *
+* Returns false if io_uring is not available on this host.      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool StartIoRing();
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        RunRingRequests                        *
+*------------------------- Description -------------------------*
+* Submits every request to the calling thread's ring with as few*
+* io_uring_enter() calls as the ring size allows, then waits    *
+* until all of them complete. Each request's result is filled   *
+* in like the return value of read() or write(). If the ring    *
+* stops taking requests, the ones it never took get -errno.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* RingRequest requests[]: The reads and writes to run.          *
+*                                                               *
+* const int count: The number of requests.                      *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the requests ran on the ring.                 *
+* Returns false if the thread has no ring, in which case none of*
+* the requests were run.                                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool RunRingRequests(RingRequest requests[], const int count);
+
+#endif
@@ -0,0 +1,246 @@
+#include "ClientAPI.h"
+#include <sys/socket.h>     // socket, connect
+#include <netinet/in.h>     // htons
+#include <arpa/inet.h>      // inet_pton
+#include <netinet/tcp.h>    // TCP_NODELAY
+#include <strings.h>        // bzero
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//function headers
+int ConnectToServer(const char *address);
+bool SendRoomRequest(const int socket, const char request[], const char name[], bool &accepted);
+void RoomName(const int number, char name[]);
+double Percentile(std::vector<double> &samples, const double percent);
+
+/*===============================================================
+||                          Constants                          ||
+===============================================================*/
+const int GAME_PORT = 2928;                 // The server game port
+const int RESPONSE_BUFFER_SIZE = 64;        // The size of the buffer a response is read into
+const int ROOM_NAME_SIZE = 16;              // The size of the buffer a room name is built in
+const int SAMPLES_PER_LEVEL = 200;          // The most requests timed at each table count
+// The table counts latency is measured at
+const int TABLE_COUNTS[] = {10, 100, 1000, 10000, 100000};
+const char* CREATE_REQUEST = "CREATEGM";    // The client request to create a game
+const char* JOIN_REQUEST = "JOINGAME";      // The client request to join a game
+const char* SERVER_TRUE = "TTTTTTTT";       // The response from the server if an action was valid
+
+/*===============================================================
+||                            Main                             ||
+===============================================================*/
+
+// Measures how long CREATE and JOIN take as the number of open tables on
+// a running server grows. Every table is made by one lobby connection, and
+// each timed JOIN uses a new connection, since joining leaves the lobby.
+int main(int argc, char *argv[])
+{
+    const char *address = (argc > 1) ? argv[1] : "127.0.0.1";
+    int lobbySocket = ConnectToServer(address);
+    if (lobbySocket < 0)
+    {
+        std::cout << "Could not connect to " << address << std::endl;
+        return 1;
+    }
+
+    std::cout << std::setw(8) << "tables"
+              << std::setw(16) << "create p50 us" << std::setw(16) << "create p99 us"
+              << std::setw(16) << "join p50 us" << std::setw(16) << "join p99 us" << std::endl;
+
+    char name[ROOM_NAME_SIZE];
+    bool accepted;
+    int tableCount = 0;
+    std::vector<double> createTimes;
+    std::vector<double> joinTimes;
+    for (const int level : TABLE_COUNTS)
+    {
+        // the tables made for this level, the last few of which are timed
+        const int firstNewTable = tableCount;
+        const int samples = std::min(SAMPLES_PER_LEVEL, level - firstNewTable);
+
+        // fill the server up to just short of the table count
+        while (tableCount < level - samples)
+        {
+            RoomName(tableCount, name);
+            if (!SendRoomRequest(lobbySocket, CREATE_REQUEST, name, accepted) || !accepted)
+            {
+                std::cout << "Could not create table " << name << std::endl;
+                return 1;
+            }
+            tableCount++;
+        }
+
+        // time creating the rest
+        createTimes.clear();
+        while (tableCount < level)
+        {
+            RoomName(tableCount, name);
+            auto start = std::chrono::steady_clock::now();
+            bool stillConnected = SendRoomRequest(lobbySocket, CREATE_REQUEST, name, accepted);
+            auto end = std::chrono::steady_clock::now();
+            if (!stillConnected || !accepted)
+            {
+                std::cout << "Could not create table " << name << std::endl;
+                return 1;
+            }
+            createTimes.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            tableCount++;
+        }
+
+        // time joining tables spread across the ones made for this level, so each is only joined once
+        joinTimes.clear();
+        const int spacing = (level - firstNewTable) / samples;
+        for (int i = 0; i < samples; i++)
+        {
+            int joinSocket = ConnectToServer(address);
+            if (joinSocket < 0)
+            {
+                std::cout << "Could not connect to " << address << std::endl;
+                return 1;
+            }
+            RoomName(firstNewTable + i * spacing, name);
+            auto start = std::chrono::steady_clock::now();
+            bool stillConnected = SendRoomRequest(joinSocket, JOIN_REQUEST, name, accepted);
+            auto end = std::chrono::steady_clock::now();
+            CloseConnection(joinSocket);
+            if (!stillConnected || !accepted)
+            {
+                std::cout << "Could not join table " << name << std::endl;
+                return 1;
+            }
+            joinTimes.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << level
+                  << std::setw(16) << Percentile(createTimes, 0.5) << std::setw(16) << Percentile(createTimes, 0.99)
+                  << std::setw(16) << Percentile(joinTimes, 0.5) << std::setw(16) << Percentile(joinTimes, 0.99) << std::endl;
+    }
+
+    CloseConnection(lobbySocket);
+    return 0;
+}
+
+/*===============================================================
+||                      Helper Functions                       ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        ConnectToServer                        *
+*------------------------- Description -------------------------*
+* Open a TCP connection to the server's game port, skipping the *
+* broadcast used to find it. Requests are sent without delay.   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char *address: The IPv4 address of the server.          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the connected socket. Returns -1 if the server could  *
+* not be reached.                                               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ConnectToServer(const char *address)
+{
+    sockaddr_in serverAddress;
+    bzero((char*) &serverAddress, sizeof(serverAddress));
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(GAME_PORT);
+    if (inet_pton(AF_INET, address, &serverAddress.sin_addr) != 1)
+    {
+        return -1;
+    }
+
+    int gameSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (gameSocket < 0)
+    {
+        return -1;
+    }
+    if (connect(gameSocket, (sockaddr*)&serverAddress, sizeof(serverAddress)) < 0)
+    {
+        CloseConnection(gameSocket);
+        return -1;
+    }
+
+    // send each request right away, so the timings are the server's and not Nagle's
+    int noDelay = 1;
+    setsockopt(gameSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return gameSocket;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendRoomRequest                        *
+*------------------------- Description -------------------------*
+* Send a request naming a room and wait for the server's answer.*
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: The connection to send the request on.      *
+*                                                               *
+* const char request[]: The request to send.                    *
+*                                                               *
+* const char name[]: The name of the room.                      *
+*                                                               *
+* bool &accepted: Set to true if the server accepted it.        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the server is still active. *
+* Returns false if the connection to the server has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool SendRoomRequest(const int socket, const char request[], const char name[], bool &accepted)
+{
+    char response[RESPONSE_BUFFER_SIZE];
+    accepted = false;
+    if (!SendDataToServer(socket, request) || !SendDataToServer(socket, name))
+    {
+        return false;
+    }
+    if (!ReadDataFromServer(socket, response, RESPONSE_BUFFER_SIZE))
+    {
+        return false;
+    }
+    accepted = (strcmp(response, SERVER_TRUE) == 0);
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            RoomName                           *
+*------------------------- Description -------------------------*
+* Build the name of the nth room made by the benchmark.         *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int number: The number of the room.                     *
+*                                                               *
+* char name[]: Where the name is placed. At least               *
+*   ROOM_NAME_SIZE long.                                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void RoomName(const int number, char name[])
+{
+    snprintf(name, ROOM_NAME_SIZE, "b%07d", number);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           Percentile                          *
+*------------------------- Description -------------------------*
+* Find a percentile of a set of timings.                        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* std::vector<double> &samples: The timings. Sorted in place.   *
+*                                                               *
+* const double percent: The percentile to find, from 0 to 1.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the timing at that percentile.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+double Percentile(std::vector<double> &samples, const double percent)
+{
+    std::sort(samples.begin(), samples.end());
+    size_t index = (size_t)(percent * (samples.size() - 1));
+    return samples[index];
+}
\ No newline at end of file
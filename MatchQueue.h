@@ -0,0 +1,211 @@
+#ifndef MATCHQUEUE_H
+#define MATCHQUEUE_H
+#include <atomic>           // atomic
+#include <cstddef>          // size_t
+#include <cstdint>          // intptr_t
+#include <memory>           // unique_ptr
+#include "Registry.h"       // CACHE_LINE_SIZE
+
+// A first in, first out queue of fixed size that many threads can add to and
+// take from at once without a lock. Each cell carries a sequence number that
+// says whether it is waiting to be filled or to be emptied, and a thread claims
+// a cell by moving the shared add or take position past it, so threads only
+// retry when two of them race for the same cell. Used to hold the clients
+// waiting to be seated by matchmaking.
+template <typename Item>
+class MatchQueue
+{
+    private:
+        /*===============================================================
+        ||                      Private Data Types                     ||
+        ===============================================================*/
+
+        // One spot in the queue
+        struct Cell
+        {
+            // Equal to the position it is next filled at while empty, and one past it once filled
+            std::atomic<size_t> sequence;
+            Item item;                      // The item held, once filled
+        };
+
+        /*===============================================================
+        ||                      Private Variables                      ||
+        ===============================================================*/
+        std::unique_ptr<Cell[]> cells;  // The spots in the queue, used in a ring
+        size_t mask;                    // One less than the number of cells, to wrap a position into the ring
+        // The position the next item is added at. Kept off the take position's cache line
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> pushAt;
+        // The position the next item is taken from
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> popAt;
+
+    public:
+        /*===============================================================
+        ||                       Public Functions                      ||
+        ===============================================================*/
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          Constructor                          *
+        *------------------------- Description -------------------------*
+        * Make an empty queue.                                          *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const size_t capacity: The most items held at once. Must be a *
+        *   power of two.                                               *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        MatchQueue(const size_t capacity);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Push                             *
+        *------------------------- Description -------------------------*
+        * Add an item to the back of the queue. Safe to call from any   *
+        * thread.                                                       *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Item &item: The item to add.                            *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the item was added.                           *
+        * Returns false if the queue is full.                           *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool Push(const Item &item);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Pop                              *
+        *------------------------- Description -------------------------*
+        * Take the item at the front of the queue. Safe to call from any*
+        * thread.                                                       *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * Item &item: Set to the item taken.                            *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if an item was taken.                            *
+        * Returns false if the queue is empty.                          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool Pop(Item &item);
+
+        // The queue is shared by reference, never copied
+        MatchQueue(const MatchQueue&) = delete;
+        MatchQueue& operator=(const MatchQueue&) = delete;
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          Constructor                          *
+*------------------------- Description -------------------------*
+* Make an empty queue.                                          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const size_t capacity: The most items held at once. Must be a *
+*   power of two.                                               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Item>
+MatchQueue<Item>::MatchQueue(const size_t capacity)
+    : cells(new Cell[capacity]), mask(capacity - 1), pushAt(0), popAt(0)
+{
+    for (size_t i = 0; i < capacity; i++)
+    {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                              Push                             *
+*------------------------- Description -------------------------*
+* Add an item to the back of the queue. Safe to call from any   *
+* thread.                                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Item &item: The item to add.                            *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the item was added.                           *
+* Returns false if the queue is full.                           *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Item>
+bool MatchQueue<Item>::Push(const Item &item)
+{
+    size_t position = pushAt.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Cell &cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t lag = (intptr_t)sequence - (intptr_t)position;
+        if (lag == 0)
+        {
+            // the cell is empty, so claim it before another thread does
+            if (pushAt.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                cell.item = item;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (lag < 0)
+        {
+            // the cell still holds an item from a lap ago
+            return false;
+        }
+        else
+        {
+            // another thread filled this cell first
+            position = pushAt.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                              Pop                              *
+*------------------------- Description -------------------------*
+* Take the item at the front of the queue. Safe to call from any*
+* thread.                                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Item &item: Set to the item taken.                            *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if an item was taken.                            *
+* Returns false if the queue is empty.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Item>
+bool MatchQueue<Item>::Pop(Item &item)
+{
+    size_t position = popAt.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Cell &cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t lag = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (lag == 0)
+        {
+            // the cell is filled, so claim it before another thread does
+            if (popAt.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                item = cell.item;
+                cell.sequence.store(position + mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (lag < 0)
+        {
+            // the cell has not been filled yet
+            return false;
+        }
+        else
+        {
+            // another thread emptied this cell first
+            position = popAt.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+#include <cstddef>          // size_t
+#include <functional>       // hash
+#include <memory>           // shared_ptr
+#include <mutex>            // mutex, lock_guard
+#include <unordered_map>    // unordered_map
+
+/*===============================================================
+||                       Public Constants                      ||
+===============================================================*/
+const int REGISTRY_SHARD_COUNT = 64;    // The number of independently locked pieces a registry is split into
+const int CACHE_LINE_SIZE = 64;         // Keeps each shard's lock off its neighbours' cache lines
+
+// A map that many threads can add to, look up, and remove from at once.
+// Keys are spread across REGISTRY_SHARD_COUNT shards by hash, and each shard
+// has its own lock, so threads only wait on each other when their keys land
+// in the same shard. Items are handed out as shared handles, so an item
+// outlives its removal from the registry until every thread still holding a
+// handle to it lets go. Holding a handle is all it takes to read an item safely.
+template <typename Key, typename Value>
+class Registry
+{
+    private:
+        /*===============================================================
+        ||                      Private Data Types                     ||
+        ===============================================================*/
+
+        // One independently locked piece of the registry
+        struct alignas(CACHE_LINE_SIZE) Shard
+        {
+            std::mutex lock;                                    // Guards items
+            std::unordered_map<Key, std::shared_ptr<Value>> items;  // The items whose keys hash to this shard
+        };
+
+        /*===============================================================
+        ||                      Private Variables                      ||
+        ===============================================================*/
+        Shard shards[REGISTRY_SHARD_COUNT];
+
+        /*===============================================================
+        ||                      Private Functions                      ||
+        ===============================================================*/
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                            ShardOf                            *
+        *------------------------- Description -------------------------*
+        * Find the shard a key belongs to.                              *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Key &key: The key to find the shard of.                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the shard holding the key, if it is held at all.      *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        Shard& ShardOf(const Key &key);
+
+    public:
+        /*===============================================================
+        ||                       Public Functions                      ||
+        ===============================================================*/
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             Insert                            *
+        *------------------------- Description -------------------------*
+        * Add an item, unless one with the same key is already held.    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Key &key: The key to add the item under.                *
+        *                                                               *
+        * std::shared_ptr<Value> value: The item to add.                *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the added item. Returns nullptr if the key was taken. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::shared_ptr<Value> Insert(const Key &key, std::shared_ptr<Value> value);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Find                             *
+        *------------------------- Description -------------------------*
+        * Look up an item by key.                                       *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Key &key: The key of the item.                          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns a handle to the item, which stays valid for as long as*
+        * the handle is held, even if the item is erased.               *
+        * Returns nullptr if no item has the key.                       *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::shared_ptr<Value> Find(const Key &key);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             Erase                             *
+        *------------------------- Description -------------------------*
+        * Remove an item. It is freed once no thread holds a handle to  *
+        * it any more.                                                  *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Key &key: The key of the item.                          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if an item was removed.                          *
+        * Returns false if no item has the key.                         *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool Erase(const Key &key);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                            ForEach                            *
+        *------------------------- Description -------------------------*
+        * Visit every item, one shard at a time. Only the shard being   *
+        * visited is locked, so items may be added to or removed from   *
+        * other shards while this runs.                                 *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * Visit visit: Called as visit(key, value) for each item. It    *
+        *   must not use the registry.                                  *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        template <typename Visit>
+        void ForEach(Visit visit);
+};
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            ShardOf                            *
+*------------------------- Description -------------------------*
+* Find the shard a key belongs to.                              *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Key &key: The key to find the shard of.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the shard holding the key, if it is held at all.      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Key, typename Value>
+typename Registry<Key, Value>::Shard& Registry<Key, Value>::ShardOf(const Key &key)
+{
+    return shards[std::hash<Key>{}(key) % REGISTRY_SHARD_COUNT];
+}
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                             Insert                            *
+*------------------------- Description -------------------------*
+* Add an item, unless one with the same key is already held.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Key &key: The key to add the item under.                *
+*                                                               *
+* std::shared_ptr<Value> value: The item to add.                *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the added item. Returns nullptr if the key was taken. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Key, typename Value>
+std::shared_ptr<Value> Registry<Key, Value>::Insert(const Key &key, std::shared_ptr<Value> value)
+{
+    Shard &shard = ShardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto inserted = shard.items.emplace(key, std::move(value));
+    if (!inserted.second)
+    {
+        return nullptr;
+    }
+    return inserted.first->second;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                              Find                             *
+*------------------------- Description -------------------------*
+* Look up an item by key.                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Key &key: The key of the item.                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns a handle to the item, which stays valid for as long as*
+* the handle is held, even if the item is erased.               *
+* Returns nullptr if no item has the key.                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Key, typename Value>
+std::shared_ptr<Value> Registry<Key, Value>::Find(const Key &key)
+{
+    Shard &shard = ShardOf(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto found = shard.items.find(key);
+    if (found == shard.items.end())
+    {
+        return nullptr;
+    }
+    return found->second;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                             Erase                             *
+*------------------------- Description -------------------------*
+* Remove an item. It is freed once no thread holds a handle to  *
+* it any more.                                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Key &key: The key of the item.                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if an item was removed.                          *
+* Returns false if no item has the key.                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Key, typename Value>
+bool Registry<Key, Value>::Erase(const Key &key)
+{
+    // if this was the last handle, free the item after the shard is unlocked
+    std::shared_ptr<Value> erased;
+    Shard &shard = ShardOf(key);
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto found = shard.items.find(key);
+        if (found == shard.items.end())
+        {
+            return false;
+        }
+        erased = std::move(found->second);
+        shard.items.erase(found);
+    }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            ForEach                            *
+*------------------------- Description -------------------------*
+* Visit every item, one shard at a time. Only the shard being   *
+* visited is locked, so items may be added to or removed from   *
+* other shards while this runs.                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Visit visit: Called as visit(key, value) for each item. It    *
+*   must not use the registry.                                  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+template <typename Key, typename Value>
+template <typename Visit>
+void Registry<Key, Value>::ForEach(Visit visit)
+{
+    for (Shard &shard : shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        for (auto &item : shard.items)
+        {
+            visit(item.first, *item.second);
+        }
+    }
+}
+
+#endif
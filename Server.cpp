@@ -1,72 +1,229 @@
 #include "ServerConnection.h"
+#include "TableEngine.h"
 #include <pthread.h>
 #include <iterator>
 #include <random>
 #include <algorithm>
 #include <iostream>
+#include <cstring>
+#include <vector>
+#include <deque>
 
 //thread function headers
+void *DiscoveryRoom(void *arg);
+void *AcceptRoom(void *arg);
 void *LobbyRoom(void *arg);
-void *GameRoom(void *arg);
+void *MatchRoom(void *arg);
+
+//table coroutine headers
+TableTask GameRoom(std::shared_ptr<Game> gameHandle, ServerConnection *server);
+TableTask WaitForPlayers(Game *game, bool &isFull);
+TableTask WaitForRequest(ServerConnection *server, const int clientSocket);
+TableTask WaitForStateWindows(ServerConnection *server, const int clientSockets[], const int count);
+TableTask FinishRound(Game *game, ServerConnection *server);
+TableTask SetBets(Game *game, ServerConnection *server);
+TableTask RunPlayer(Game *game, std::shared_ptr<Client> playerHandle, ServerConnection *server);
+TableTask RunDealer(Game* game, ServerConnection *server);
+TableTask SendStateToAllPlayers(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn);
 
 // helper function headers
-void FillDeck(Game *game);
-void ShuffleDeck(Game *game);
+bool HandleLobbyRequest(ServerConnection *server, const int eventQueue, LobbyFeed *feed, const int clientSocket);
+std::shared_ptr<Game> StartQuickTable(ServerConnection *server);
+void ChangeShoe(Game *game);
+Card DrawCard(Game *game);
 void DealCardToPlayer(Game *game, Client *player);
 void RevealHiddenCard(Client *player);
 void DealStartingHands(Game *game);
-void SetBets(Game *game, ServerConnection *server);
-int GetPlayerScore(Client *player);
-int GetDealerScore(Game *game);
-void RunPlayer(Game *game, Client *player, ServerConnection *server);
-void RunDealer(Game* game, ServerConnection *server);
 void PayoutPlayer(Game *game, Client *player);
+void BuildStateForPlayer(Game *game, const bool isNewRound, const int playerTurn, Client *player, StateData &state);
 bool SendStateToPlayer(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn, Client *player);
-void SendStateToAllPlayers(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn);
 
 /*===============================================================
 ||                          Constants                          ||
 ===============================================================*/
 const int DEALER_STAND_ON = 17; // The value the dealer will stand on
-const int MAX_SAFE_SCORE = 21;  // The highets score before a bust
+const int ACCEPT_THREAD_COUNT = 1;  // The default number of threads accepting clients
+const int LOBBY_THREAD_COUNT = 4;   // The default number of threads serving clients in the lobby
+const int LISTEN_BACKLOG = 1024;    // The default most clients waiting to be accepted per accept thread
+const int MAX_LOBBY_EVENTS = 64;    // The most ready lobby sockets handled per wake up
+const int TABLE_WORKER_COUNT = 4;   // The default number of threads running every table
+const int SHOE_WORKER_COUNT = 1;    // The default number of threads shuffling spare shoes
+const int MAX_QUICK_JOINS = 64;     // The most clients waiting on matchmaking seated per wake up
+const int WARM_TABLE_COUNT = 4;     // The tables kept running and waiting for their first player
 
 /*===============================================================
 ||                      Custom Data Types                      ||
 ===============================================================*/
 struct LobbyData
 {
-    int clientSocket;
+    int eventQueue;     // The queue of this lobby thread's clients
+    LobbyFeed *feed;    // The lobby changes pushed to this lobby thread's subscribers
     class ServerConnection *server;
 };
 
-struct GameData
+struct AcceptData
 {
+    int eventQueue;     // The queue of this accept thread's game socket
+    int gameSocket;     // The socket this accept thread accepts clients from
+    std::vector<LobbyData *> lobbies;   // The lobby threads new clients are spread over
     class ServerConnection *server;
-    Game *game;
 };
 
 /*===============================================================
 ||                            Main                             ||
 ===============================================================*/
-int main()
+int main(int argc, char *argv[])
 {
     std::cout << "Staring Server" << std::endl;
+
+    // pick how data moves to and from clients, and how many are accepted at once
+    int acceptThreadCount = ACCEPT_THREAD_COUNT;
+    int lobbyThreadCount = LOBBY_THREAD_COUNT;
+    int backlog = LISTEN_BACKLOG;
+    int tableWorkerCount = TABLE_WORKER_COUNT;
+    int shoeWorkerCount = SHOE_WORKER_COUNT;
+    bool hasShoeSeed = false;
+    uint64_t shoeSeed = 0;
+    bool isLoggingSeeds = false;
+    DealingMode dealingMode = SHOE_DEALING;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--io-uring") == 0)
+        {
+            if (UseIoUringTransport())
+            {
+                std::cout << "Using io_uring transport" << std::endl;
+            }
+            else
+            {
+                std::cout << "io_uring not available, using read/write" << std::endl;
+            }
+        }
+        else if (strcmp(argv[i], "--acceptors") == 0 && i + 1 < argc)
+        {
+            acceptThreadCount = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--lobby-threads") == 0 && i + 1 < argc)
+        {
+            lobbyThreadCount = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--backlog") == 0 && i + 1 < argc)
+        {
+            backlog = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--table-workers") == 0 && i + 1 < argc)
+        {
+            tableWorkerCount = std::max(1, atoi(argv[++i]));
+        }
+        // 0 leaves each table to shuffle its own shoes
+        else if (strcmp(argv[i], "--shoe-workers") == 0 && i + 1 < argc)
+        {
+            shoeWorkerCount = std::max(0, atoi(argv[++i]));
+        }
+        // replay every table's shoes from a logged seed
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            shoeSeed = strtoull(argv[++i], nullptr, 10);
+            hasShoeSeed = true;
+        }
+        else if (strcmp(argv[i], "--log-seeds") == 0)
+        {
+            isLoggingSeeds = true;
+        }
+        // deal every table like a continuous shuffling machine
+        else if (strcmp(argv[i], "--csm") == 0)
+        {
+            dealingMode = CONTINUOUS_DEALING;
+        }
+    }
+
     //make a server connection
     class ServerConnection server;
-    while(1)
+
+    // stop before any game socket is opened if another server already has the ports
+    if (!server.OpenDiscoverySocket())
+    {
+        std::cout << "Could not open discovery socket, is another server running?" << std::endl;
+        return 1;
+    }
+    if (hasShoeSeed || isLoggingSeeds)
+    {
+        // a seed has to be known to be logged
+        if (!hasShoeSeed)
+        {
+            std::random_device device;
+            shoeSeed = ((uint64_t) device() << 32) | device();
+        }
+        server.SeedShoes(shoeSeed, isLoggingSeeds);
+    }
+    server.SetDealingMode(dealingMode);
+
+    // start the threads shoes are shuffled on before any table is made
+    if (shoeWorkerCount > 0 && !StartShoePool(shoeWorkerCount))
+    {
+        std::cout << "Could not start shoe workers" << std::endl;
+        return 1;
+    }
+
+    // start the threads every table runs on
+    if (!StartTableWorkers(tableWorkerCount))
+    {
+        std::cout << "Could not start table workers" << std::endl;
+        return 1;
+    }
+
+    // answer clients looking for the server separately from accepting them
+    pthread_t discovery;
+    pthread_create(&discovery, NULL, DiscoveryRoom, (void *) &server);
+
+    // seat clients asking for any table separately, so matchmaking never holds up the lobby
+    pthread_t matchmaking;
+    pthread_create(&matchmaking, NULL, MatchRoom, (void *) &server);
+
+    // start the lobby threads. Each keeps the clients handed to it until they join a game
+    std::vector<LobbyData *> lobbyData;
+    std::vector<pthread_t> lobbies;
+    for (int i = 0; i < lobbyThreadCount; i++)
     {
-        // wait for a client to connect
-        int newSocket = server.AcceptNewClient();
-        std::cout << "Server found Client: " << newSocket << std::endl;
-    
-        // once a client connects, place them on a lobby thread
-        pthread_t newLobby;
         struct LobbyData *data = new LobbyData;
-        data->clientSocket = newSocket;
+        data->eventQueue = StartEventQueue();
+        data->feed = server.OpenLobbyFeed();
         data->server = &server;
+        if (data->feed == nullptr || !WatchListener(data->eventQueue, data->feed->ticker))
+        {
+            std::cout << "Could not start lobby feed" << std::endl;
+            return 1;
+        }
+
+        pthread_t newLobby;
         pthread_create(&newLobby, NULL, LobbyRoom, (void *) data);
+        lobbyData.push_back(data);
+        lobbies.push_back(newLobby);
+    }
+
+    // start the accept threads. Each accepts from its own game socket and does nothing
+    // else, so a lobby thread held up sending to a user never stops new users connecting
+    for (int i = 0; i < acceptThreadCount; i++)
+    {
+        struct AcceptData *data = new AcceptData;
+        data->eventQueue = StartEventQueue();
+        data->gameSocket = server.OpenGameSocket(backlog);
+        data->lobbies = lobbyData;
+        data->server = &server;
+        if (data->gameSocket < 0 || !WatchListener(data->eventQueue, data->gameSocket))
+        {
+            std::cout << "Could not open game socket" << std::endl;
+            return 1;
+        }
+
+        pthread_t newAcceptor;
+        pthread_create(&newAcceptor, NULL, AcceptRoom, (void *) data);
     }
 
+    for (pthread_t lobby : lobbies)
+    {
+        pthread_join(lobby, NULL);
+    }
 }
 
 /*===============================================================
@@ -74,341 +231,487 @@ int main()
 ===============================================================*/
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                          *LobbyRoom                           *
+*                        *DiscoveryRoom                         *
 *------------------------- Description -------------------------*
-* A thread to handle the user until they join a game.           *
+* A thread to answer every client looking for the server, so    *
+* discovery never holds up accepting connections.               *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* void *arg: The data used to handle the client in the lobby.   *
+* void *arg: The server connection to answer for.               *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void *LobbyRoom(void *arg)
+void *DiscoveryRoom(void *arg)
 {
-    // format thread data
-    struct LobbyData *data = (struct LobbyData *)arg;
-
-    // wait for user to select a room
-    bool waitingOnUser = true;
-    bool disconnected = false;
-    bool noErrors;
-    bool newRoom = false;
-    do
-    {
-        
-        Action userInput = data->server->InterpretClientRequest(data->clientSocket);
-        switch (userInput)
-        {
-            case (LIST):
-                noErrors = data->server->ListGames(data->clientSocket);
-                if (!noErrors)
-                {
-                    waitingOnUser = false;
-                    disconnected = true;
-                }
-                break;
-            
-            case (CREATE):
-                std::cout << "Server creating game" << std::endl;
-                noErrors = data->server->CreateGame(data->clientSocket);
-                if (!noErrors)
-                {
-                    waitingOnUser = false;
-                    disconnected = true;
-                }
-                newRoom = true;
-                break;
-
-            case (JOIN):
-                std::cout << "Server putting Client in game" << std::endl;
-                noErrors = data->server->JoinGame(data->clientSocket);
-                if (!noErrors)
-                {
-                    disconnected = true;
-                }
-                waitingOnUser = false;
-                break;
-
-            case (UNREGISTER):
-                waitingOnUser = false;
-                disconnected = true;
-                break;
-
-            default:
-                break;
-        }
-    } while (waitingOnUser);
-
-    // if the user disconnected, don't do anything
-    if(disconnected)
-    {
-        data->server->Unregister(data->clientSocket);
-        return 0;
-    }
-
-    // if a clients makes a new room, create a new room thread
-    if (newRoom)
-    {
-        pthread_t newGame;
-        struct GameData *gameData = new GameData;
-        gameData->server = data->server;
-        gameData->game = data->server->GetUserGame(data->clientSocket);
-        pthread_create(&newGame, NULL, GameRoom, (void *) gameData);
-    }
+    class ServerConnection *server = (class ServerConnection *)arg;
+    server->AnswerDiscovery();
     return 0;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                           *GameRoom                           *
+*                          *AcceptRoom                          *
 *------------------------- Description -------------------------*
-* A thread to run a game for clients equal to PLAYER_COUNT.     *
+* A thread to accept users from one game socket and hand them   *
+* to the lobby threads in turn. Accepting is all it does, so    *
+* users can always connect however busy the lobby threads are.  *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* void *arg: The data used to handle the client in the lobby.   *
+* void *arg: The game socket and the lobby threads to hand to.  *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void *GameRoom(void *arg)
+void *AcceptRoom(void *arg)
 {
     // format thread data
-    struct GameData *data = (struct GameData *)arg;
+    struct AcceptData *data = (struct AcceptData *)arg;
 
-    // wait till all users are ready to play
-    bool waitForUser;
-    do
+    int readySocket;
+    int newSockets[MAX_LOBBY_EVENTS];
+    size_t nextLobby = 0;
+    while (true)
     {
-        waitForUser = false;
-        for (int i = 0; i < PLAYER_COUNT; i++)
+        // wait for users to connect
+        if (WaitForReadySockets(data->eventQueue, &readySocket, 1) == 0)
         {
-            if (data->game->players[i] == nullptr)
-            {
-                waitForUser = true;
-            }
+            continue;
         }
-    } while(waitForUser);
-    std::cout << "Starting Game" << std::endl;
-    data->game->isOpen = false;
-
-    // --- Set up game ---
-    // init deck
-    FillDeck(data->game);
-    ShuffleDeck(data->game);
-
-    // init player money
-    for(int i = 0; i < PLAYER_COUNT; i++)
-    {
-        data->game->players[i]->money = STARTING_MONEY;
-    }
 
-    // Game Loop
-    //SendStateToAllPlayers(data->server, data->game, false, -1);
-    bool hasPlayers = true;
-    do
-    {
-        // get bets
-        SetBets(data->game, data->server);
-        SendStateToAllPlayers(data->server, data->game, false, -1);
-
-        // deal
-        DealStartingHands(data->game);
-        SendStateToAllPlayers(data->server, data->game, false, -1);
-
-        // handle each user action
-        for (int i = 0; i < PLAYER_COUNT; i ++)
+        // take every waiting client and spread them over the lobby threads
+        int newCount = data->server->AcceptNewClients(data->gameSocket, newSockets, MAX_LOBBY_EVENTS);
+        for (int i = 0; i < newCount; i++)
         {
-            if (data->game->players[i] != nullptr)
+            std::cout << "Server found Client: " << newSockets[i] << std::endl;
+            if (!WatchSocket(data->lobbies[nextLobby]->eventQueue, newSockets[i]))
             {
-                RunPlayer(data->game, data->game->players[i], data->server);
+                data->server->Unregister(newSockets[i]);
             }
+            nextLobby = (nextLobby + 1) % data->lobbies.size();
         }
+    }
+    return 0;
+}
 
-        // play dealer
-        std::cout << "Dealer Playing" << std::endl;
-        RunDealer(data->game, data->server);
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          *LobbyRoom                           *
+*------------------------- Description -------------------------*
+* A thread to handle users in the lobby until they join a game. *
+* Each lobby thread waits on its own event queue, which holds   *
+* the users handed to it and the ticker of its lobby feed, so   *
+* idle users cost a watched socket instead of a thread. A       *
+* request is only handled once all of it has arrived, so        *
+* reading never waits on a user.                                *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* void *arg: The data used to handle the clients in the lobby.  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void *LobbyRoom(void *arg)
+{
+    // format thread data
+    struct LobbyData *data = (struct LobbyData *)arg;
 
-        // for each winner, pay out, for each loser, lose money
-        std::cout << "Paying out" << std::endl;
-        for (int i = 0; i < PLAYER_COUNT; i ++)
+    int readySockets[MAX_LOBBY_EVENTS];
+    while (true)
+    {
+        // wait for users to send a request
+        int readyCount = WaitForReadySockets(data->eventQueue, readySockets, MAX_LOBBY_EVENTS);
+        for (int i = 0; i < readyCount; i++)
         {
-            if (data->game->players[i] != nullptr)
+            // push the lobby changes gathered since the last tick to the subscribers
+            if (readySockets[i] == data->feed->ticker)
             {
-                PayoutPlayer(data->game, data->game->players[i]);
+                ClearTimer(data->feed->ticker);
+                data->server->SendLobbyEvents(data->feed);
+                continue;
             }
-        }
-        SendStateToAllPlayers(data->server, data->game, true, -1);
 
-        // For each player with no money, give them some pity money
-        std::cout << "Pitty money" << std::endl;
-        for (int i = 0; i < PLAYER_COUNT; i ++)
-        {
-            if (data->game->players[i] != nullptr)
+            // take what the user has sent without waiting for more, so a user part way
+            // through a request never holds up the rest of the lobby thread
+            bool isConnected;
+            do
             {
-                if(data->game->players[i]->money <= 0 )
-                {
-                    data->game->players[i]->money = 10;
-                }
+                isConnected = ReadWaitingData(readySockets[i]);
+            } while (isConnected && HasWaitingData(readySockets[i]) && !data->server->HasClientRequest(readySockets[i]));
+
+            // handle every whole request the user has sent, not just the first. A user
+            // that is gone is handled once more, which finds that out and lets them go
+            bool stillInLobby = true;
+            while (stillInLobby && (!isConnected || data->server->HasClientRequest(readySockets[i])))
+            {
+                stillInLobby = HandleLobbyRequest(data->server, data->eventQueue, data->feed, readySockets[i]);
             }
-        }
 
-        // remove cards from all players and dealer
-        std::cout << "discarding hands" << std::endl;
-        for (int i = 0; i < PLAYER_COUNT; i ++)
-        {
-            if (data->game->players[i] != nullptr)
+            // keep watching users that have not left the lobby
+            if (stillInLobby)
             {
-                data->game->players[i]->shownCards.clear();
+                RewatchSocket(data->eventQueue, readySockets[i]);
             }
         }
-        data->game->shownCards.clear();
+    }
+    return 0;
+}
 
-        //shuffle deck if below half way
-        
-        if (data->game->deckIterator >= (NUM_DECKS*CARDS_IN_STANDARD_DECK / 2))
-        {
-            std::cout << "Shuffling deck" << std::endl;
-            ShuffleDeck(data->game);
-        }
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          *MatchRoom                           *
+*------------------------- Description -------------------------*
+* A thread to seat the users waiting on matchmaking. Every user *
+* waiting is taken at once and seated in order, filling one     *
+* table before moving to the next, so users are never split     *
+* across half full tables. Tables are taken from a few kept     *
+* running and waiting for their first player, and more are made *
+* if a batch needs them, so a user is seated without waiting on *
+* a table to be made.                                           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* void *arg: The server connection to seat users through.       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void *MatchRoom(void *arg)
+{
+    class ServerConnection *server = (class ServerConnection *)arg;
 
-        // Reset player bet to 0
-        for (int i = 0; i < PLAYER_COUNT; i ++)
+    std::deque<std::shared_ptr<Game>> warmTables;   // Tables running with no one seated yet
+    std::shared_ptr<Game> fillingTable;             // The table users are seated at until it has no seat left
+    int waitingSockets[MAX_QUICK_JOINS];
+    while (true)
+    {
+        // get tables ready while no one is waiting
+        while ((int)warmTables.size() < WARM_TABLE_COUNT)
         {
-            if (data->game->players[i] != nullptr)
-            {
-                data->game->players[i]->mostRecentBet = 0;
-            }
+            warmTables.push_back(StartQuickTable(server));
         }
 
-        // Check if users are still in room
-        std::cout << "Making sure there are still players" << std::endl;
-        hasPlayers = false;
-        for (int i = 0; i < PLAYER_COUNT; i++)
+        // seat everyone waiting, moving to a new table once one fills,
+        // closes, or is filled by users joining it from the lobby
+        int waitingCount = server->WaitForQuickJoins(waitingSockets, MAX_QUICK_JOINS);
+        for (int i = 0; i < waitingCount; i++)
         {
-            if (data->game->players[i] != nullptr)
+            while (fillingTable == nullptr || !server->SeatQuickJoiner(waitingSockets[i], fillingTable))
             {
-                hasPlayers = true;
+                if (warmTables.empty())
+                {
+                    fillingTable = StartQuickTable(server);
+                }
+                else
+                {
+                    fillingTable = warmTables.front();
+                    warmTables.pop_front();
+                }
             }
         }
-    } while (hasPlayers);
-    std::cout << "Shutting down game" << std::endl;
-    data->server->ShutDownGame(data->game);
+    }
     return 0;
 }
 
 /*===============================================================
-||                      Helper Functions                       ||
+||                      Table Coroutines                       ||
 ===============================================================*/
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                           FillDeck                            *
+*                            GameRoom                           *
 *------------------------- Description -------------------------*
-* Fill the game deck with cards.                                *
+* A table to run a game for clients equal to PLAYER_COUNT. The  *
+* table sleeps until its seats fill, then moves through betting,*
+* playing, the dealer's turn and payout each round. It runs on a*
+* table worker and parks whenever it waits on a player, so it   *
+* only holds a thread while it has something to do.             *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* Game *game: The game to fill the deck for.                    *
+* std::shared_ptr<Game> gameHandle: The game to run. Held until *
+*   the table finishes, so the game outlives its removal from   *
+*   the server's list.                                          *
+*                                                               *
+* ServerConnection *server: The server connection to talk to the*
+*   clients through.                                            *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void FillDeck(Game *game)
+TableTask GameRoom(std::shared_ptr<Game> gameHandle, ServerConnection *server)
 {
-    game->deckIterator = 0;
-    for (int i = 0; i < NUM_DECKS; i++)
+    Game *game = gameHandle.get();
+
+    // run the table one stage at a time until everyone leaves
+    game->state = WAITING_FOR_PLAYERS;
+    while (game->state != CLOSED)
     {
-        for (int j = 0; j < CARDS_IN_STANDARD_DECK; j++)
+        switch (game->state)
         {
-            
-            game->deck[game->deckIterator] = STANDARD_DECK[j];
-            game->deckIterator++;
+            case (WAITING_FOR_PLAYERS):
+                // sleep until all users are ready to play
+                bool isFull;
+                co_await WaitForPlayers(game, isFull);
+                if (!isFull)
+                {
+                    game->state = CLOSED;
+                    break;
+                }
+                std::cout << "Starting Game" << std::endl;
+                {
+                    std::lock_guard<std::mutex> guard(game->seatEvents.lock);
+                    server->UpdateLobby(*game);
+                }
+
+                // --- Set up game ---
+                // init deck
+                if (game->dealingMode == CONTINUOUS_DEALING)
+                {
+                    FillContinuousShoe(*game->shoes);
+                }
+                else
+                {
+                    ChangeShoe(game);
+                }
+
+                // init player money
+                for(int i = 0; i < PLAYER_COUNT; i++)
+                {
+                    game->players[i]->money = STARTING_MONEY;
+                }
+                game->state = BETTING;
+                break;
+
+            case (BETTING):
+                // get bets
+                co_await SetBets(game, server);
+                co_await SendStateToAllPlayers(server, game, false, -1);
+                game->state = PLAYING;
+                break;
+
+            case (PLAYING):
+                // deal
+                DealStartingHands(game);
+                co_await SendStateToAllPlayers(server, game, false, -1);
+
+                // handle each user action
+                for (int i = 0; i < PLAYER_COUNT; i ++)
+                {
+                    if (game->players[i] != nullptr)
+                    {
+                        co_await RunPlayer(game, game->players[i], server);
+                    }
+                }
+                game->state = DEALER;
+                break;
+
+            case (DEALER):
+                // play dealer
+                std::cout << "Dealer Playing" << std::endl;
+                co_await RunDealer(game, server);
+                game->state = PAYOUT;
+                break;
+
+            case (PAYOUT):
+                co_await FinishRound(game, server);
+
+                // Check if users are still in room
+                std::cout << "Making sure there are still players" << std::endl;
+                game->state = CLOSED;
+                for (int i = 0; i < PLAYER_COUNT; i++)
+                {
+                    if (game->players[i] != nullptr)
+                    {
+                        game->state = BETTING;
+                    }
+                }
+                break;
+
+            default:
+                game->state = CLOSED;
+                break;
         }
-        
     }
-    game->deckIterator = 0;
+    std::cout << "Shutting down game" << std::endl;
+    server->ShutDownGame(game);
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                          ShuffleDeck                          *
+*                         WaitForPlayers                        *
 *------------------------- Description -------------------------*
-* Shuffle the game deck.                                        *
+* Park the table until every seat in the game is taken and each *
+* player has been told they have their seat, waking only when a *
+* player joins or leaves. Closes the game to new players once   *
+* it is full. A warm game keeps waiting while it is empty until *
+* its first player sits.                                        *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* Game *game: The game to shuffle the deck for.                 *
+* Game *game: The game to wait on.                              *
+*                                                               *
+* bool &isFull: Set to true once every seat is taken, or to     *
+*   false if every player left before the game filled.          *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void ShuffleDeck(Game *game)
+TableTask WaitForPlayers(Game *game, bool &isFull)
 {
-    std::random_device rd;
-    std::mt19937 g(rd());
- 
-    std::shuffle(std::begin(game->deck), std::end(game->deck), g);
+    std::unique_lock<std::mutex> seats(game->seatEvents.lock);
+    while (true)
+    {
+        // a player only counts as ready once they were told they have their seat,
+        // so the first state never reaches them ahead of the answer
+        int seated = 0;
+        int ready = 0;
+        for (int i = 0; i < PLAYER_COUNT; i++)
+        {
+            if (game->players[i] != nullptr)
+            {
+                seated++;
+                if (game->players[i]->isSeatAnswered)
+                {
+                    ready++;
+                }
+            }
+        }
+        if ((seated == 0 && !game->isWarm) || ready == PLAYER_COUNT)
+        {
+            isFull = (ready == PLAYER_COUNT);
+            break;
+        }
+
+        // once someone sits, the game closes when it empties like any other
+        if (seated > 0)
+        {
+            game->isWarm = false;
+        }
+        co_await ParkTable{game->seatEvents.waitingTable, seats};
+    }
+    if (isFull)
+    {
+        game->isOpen = false;
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                        DealCardToPlayer                       *
+*                         WaitForRequest                        *
 *------------------------- Description -------------------------*
-* Deal a card to the player.                                    *
+* Park the table until the client has sent a whole request, so  *
+* neither InterpretClientRequest() nor the request's handler    *
+* waits on the socket. Also stops waiting if the client         *
+* disconnects.                                                  *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* Game *game: The game to deal from.                            *
+* ServerConnection *server: The server connection to talk to the*
+*   client through.                                             *
 *                                                               *
-* Client *player: The player to deal to.                        *
+* const int clientSocket: The client to wait on.                *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void DealCardToPlayer(Game *game, Client *player)
+TableTask WaitForRequest(ServerConnection *server, const int clientSocket)
 {
-    player->shownCards.push_back(game->deck[game->deckIterator]);
-    game->deckIterator++;
+    while (!server->HasClientRequest(clientSocket))
+    {
+        co_await WaitForReadable{clientSocket};
+        if (!ReadWaitingData(clientSocket))
+        {
+            // the next read finds out the client is gone
+            break;
+        }
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                        RevealHiddenCard                       *
+*                       WaitForStateWindows                     *
 *------------------------- Description -------------------------*
-* Reveal the player's hidden card                               *
+* Park the table until every client can be sent another state   *
+* without waiting on a confirmation, so one slow client doesn't *
+* hold up the other tables on the worker.                       *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* Client *player: The player to reveal the card of.             *
+* ServerConnection *server: The server connection to talk to the*
+*   clients through.                                            *
+*                                                               *
+* const int clientSockets[]: The clients to wait on.            *
+*                                                               *
+* const int count: The number of clients.                       *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void RevealHiddenCard(Client *player)
+TableTask WaitForStateWindows(ServerConnection *server, const int clientSockets[], const int count)
 {
-    player->shownCards.push_back(player->hiddenCard);
-    player->hiddenCard = "";
+    for (int i = 0; i < count; i++)
+    {
+        while (!server->HasStateWindow(clientSockets[i]))
+        {
+            co_await WaitForReadable{clientSockets[i]};
+            if (!ReadWaitingData(clientSockets[i]))
+            {
+                // sending finds out the client is gone
+                break;
+            }
+        }
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                       DealStartingHands                       *
+*                          FinishRound                          *
 *------------------------- Description -------------------------*
-* Deal the starting hands to each player and the dealer.        *
+* Pay out each player, give broke players pity money, clear the *
+* hands and bets, and return the discards or change shoes.      *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* Game *game: The game to deal the starting hands of.           *
+* Game *game: The game to finish the round of.                  *
+*                                                               *
+* ServerConnection *server: The server connection to talk to the*
+*   clients through.                                            *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void DealStartingHands(Game *game)
+TableTask FinishRound(Game *game, ServerConnection *server)
 {
-    // deal to players
-    for (int i = 0; i < PLAYER_COUNT; i++)
+    // for each winner, pay out, for each loser, lose money
+    std::cout << "Paying out" << std::endl;
+    for (int i = 0; i < PLAYER_COUNT; i ++)
     {
         if (game->players[i] != nullptr)
         {
-            //deal hidden card
-            game->players[i]->hiddenCard = game->deck[game->deckIterator];
-            game->deckIterator++;
+            PayoutPlayer(game, game->players[i].get());
+        }
+    }
+    co_await SendStateToAllPlayers(server, game, true, -1);
 
-            //deal shown card
-            DealCardToPlayer(game, game->players[i]);
+    // For each player with no money, give them some pity money
+    std::cout << "Pitty money" << std::endl;
+    for (int i = 0; i < PLAYER_COUNT; i ++)
+    {
+        if (game->players[i] != nullptr)
+        {
+            if(game->players[i]->money <= 0 )
+            {
+                game->players[i]->money = 10;
+            }
         }
     }
 
-    // deal to dealer
-    // deal hidden card
-    game->hiddenCard = game->deck[game->deckIterator];
-    game->deckIterator++;
+    // remove cards from all players and dealer
+    std::cout << "discarding hands" << std::endl;
+    for (int i = 0; i < PLAYER_COUNT; i ++)
+    {
+        if (game->players[i] != nullptr)
+        {
+            game->players[i]->shownCards.Clear();
+        }
+    }
+    game->shownCards.Clear();
 
-    // deal shown card
-    game->shownCards.push_back(game->deck[game->deckIterator]);
-    game->deckIterator++;
+    // every card is out of play, so a continuous shoe takes them all back
+    if (game->dealingMode == CONTINUOUS_DEALING)
+    {
+        ReturnDiscards(*game->shoes);
+    }
+    //change shoes if below half way
+    else if (game->deckIterator >= SHOE_CUT)
+    {
+        std::cout << "Changing shoe" << std::endl;
+        ChangeShoe(game);
+    }
+
+    // Reset player bet to 0
+    for (int i = 0; i < PLAYER_COUNT; i ++)
+    {
+        if (game->players[i] != nullptr)
+        {
+            game->players[i]->mostRecentBet = 0;
+        }
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                            SetBets                            *
 *------------------------- Description -------------------------*
-* Wait for each player to bet and store it.                     *
+* Park the table until each player bets and store it.           *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * Game *game: The game to get the bets from the players of.     *
@@ -417,9 +720,9 @@ void DealStartingHands(Game *game)
 *   client through.                                             *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void SetBets(Game *game, ServerConnection *server)
+TableTask SetBets(Game *game, ServerConnection *server)
 {
-    SendStateToAllPlayers(server, game, true, -1);
+    co_await SendStateToAllPlayers(server, game, true, -1);
     for (int i = 0; i < PLAYER_COUNT; i++)
     {
         if (game->players[i] != nullptr)
@@ -431,11 +734,13 @@ void SetBets(Game *game, ServerConnection *server)
             bool noErrors;
             do
             {
+                co_await WaitForRequest(server, game->players[i]->socket);
                 Action userInput = server->InterpretClientRequest(game->players[i]->socket);
                 switch (userInput)
                 {
                     case (BET):
                         // get requested money
+                        // the amount came with the request, so reading it doesn't wait
                         int betMoney;
                         noErrors = server->Bet(game->players[i]->socket, betMoney);
                         if (!noErrors)
@@ -451,7 +756,8 @@ void SetBets(Game *game, ServerConnection *server)
                         }
                         else
                         {
-                            SendStateToPlayer(server, game, true, i, game->players[i]);
+                            co_await WaitForStateWindows(server, &game->players[i]->socket, 1);
+                            SendStateToPlayer(server, game, true, i, game->players[i].get());
                         }
                         break;
                     
@@ -470,190 +776,10 @@ void SetBets(Game *game, ServerConnection *server)
 
                     default:
                         break;
-                }
-            } while (waitingOnUser);
-        }
-    }
-}
-
-/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                         GetPlayerScore                        *
-*------------------------- Description -------------------------*
-* Get the score of the player.                                  *
-*                                                               *
-*------------------------- Parameters --------------------------*
-* Client *player: The player to get the score of.               *
-*                                                               *
-*------------------------- Return Value ------------------------*
-* Returns the player's score.                                   *
-*                                                               *
-*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-int GetPlayerScore(Client *player)
-{
-    int playerScore = 0;
-    int numAces = 0;
-    // convert cards to score
-    for ( std::string cardStr : player->shownCards)
-    {
-        if (cardStr.compare("2") == 0)
-        {
-            playerScore += 2;
-        }
-        else if (cardStr.compare("3") == 0)
-        {
-            playerScore += 3;
-        }
-        else if (cardStr.compare("4") == 0)
-        {
-            playerScore += 4;
-        }
-        else if (cardStr.compare("5") == 0)
-        {
-            playerScore += 5;
-        }
-        else if (cardStr.compare("6") == 0)
-        {
-            playerScore += 6;
-        }
-        else if (cardStr.compare("7") == 0)
-        {
-            playerScore += 7;
-        }
-        else if (cardStr.compare("8") == 0)
-        {
-            playerScore += 8;
-        }
-        else if (cardStr.compare("9") == 0)
-        {
-            playerScore += 9;
-        }
-        else if (cardStr.compare("10") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("J") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("Q") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("K") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("A") == 0)
-        {
-            numAces++;
-            playerScore += 1;
-        }
-    }
-
-    //handle aces
-    for (int i = 0; i < numAces; i++)
-    {
-        // for each aces, see if changing to an 11 will stay under 21
-        if(playerScore + 9 <= MAX_SAFE_SCORE)
-        {
-            playerScore += 10;
-        }
-        else
-        {
-            i = numAces;
-        }
-    }
-    return playerScore;
-}
-
-/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                         GetDealerScore                        *
-*------------------------- Description -------------------------*
-* Get the score of the dealer.                                  *
-*                                                               *
-*------------------------- Parameters --------------------------*
-* Game *game: The game to get the dealer score of.              *
-*                                                               *
-*------------------------- Return Value ------------------------*
-* Returns the player's score.                                   *
-*                                                               *
-*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-int GetDealerScore(Game *game)
-{
-    int playerScore = 0;
-    int numAces = 0;
-    // convert cards to score
-    for ( std::string cardStr : game->shownCards)
-    {
-        if (cardStr.compare("2") == 0)
-        {
-            playerScore += 2;
-        }
-        else if (cardStr.compare("3") == 0)
-        {
-            playerScore += 3;
-        }
-        else if (cardStr.compare("4") == 0)
-        {
-            playerScore += 4;
-        }
-        else if (cardStr.compare("5") == 0)
-        {
-            playerScore += 5;
-        }
-        else if (cardStr.compare("6") == 0)
-        {
-            playerScore += 6;
-        }
-        else if (cardStr.compare("7") == 0)
-        {
-            playerScore += 7;
-        }
-        else if (cardStr.compare("8") == 0)
-        {
-            playerScore += 8;
-        }
-        else if (cardStr.compare("9") == 0)
-        {
-            playerScore += 9;
-        }
-        else if (cardStr.compare("10") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("J") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("Q") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("K") == 0)
-        {
-            playerScore += 10;
-        }
-        else if (cardStr.compare("A") == 0)
-        {
-            numAces++;
-            playerScore += 1;
-        }
-    }
-
-    //handle aces
-    for (int i = 0; i < numAces; i++)
-    {
-        // for each aces, see if changing to an 11 will stay under 21
-        if(playerScore + 9 <= MAX_SAFE_SCORE)
-        {
-            playerScore += 10;
-        }
-        else
-        {
-            i = numAces;
+                }
+            } while (waitingOnUser);
         }
     }
-    return playerScore;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -664,21 +790,25 @@ int GetDealerScore(Game *game)
 *------------------------- Parameters --------------------------*
 * Game *game: The game to run.                                  *
 *                                                               *
-* Client *player: The player to run.                            *
+* std::shared_ptr<Client> playerHandle: The player to run. Held *
+*   until their turn ends, so the player outlives leaving the   *
+*   game mid turn.                                              *
 *                                                               *
 * ServerConnection *server: The server connection to talk to the*
 *   client through.                                             *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void RunPlayer(Game *game, Client *player, ServerConnection *server)
+TableTask RunPlayer(Game *game, std::shared_ptr<Client> playerHandle, ServerConnection *server)
 {
+    Client *player = playerHandle.get();
+
     for (int i = 0; i < PLAYER_COUNT; i++)
     {
         if (game->players[i] != nullptr)
         {
             if (game->players[i]->socket == player->socket)
             {
-                SendStateToAllPlayers(server, game, false, i);
+                co_await SendStateToAllPlayers(server, game, false, i);
             }
         }
     }
@@ -690,9 +820,8 @@ void RunPlayer(Game *game, Client *player, ServerConnection *server)
     do
     {
         // check if user has busted
-        int playerScore = GetPlayerScore(player);
-        std::cout << "Player score: " << playerScore << std::endl;
-        if (playerScore > MAX_SAFE_SCORE)
+        std::cout << "Player score: " << player->shownCards.Score() << std::endl;
+        if (player->shownCards.IsBust())
         {
             player->hasBusted = true;
             waitingOnUser = false;
@@ -706,10 +835,17 @@ void RunPlayer(Game *game, Client *player, ServerConnection *server)
                 {
                     if (game->players[i]->socket == player->socket)
                     {
-                        SendStateToAllPlayers(server, game, false, i);
+                        co_await SendStateToAllPlayers(server, game, false, i);
                     }
                 }
             }
+
+            // a failed send has already let the user go, and their socket may belong to someone new
+            if (player->curGame == nullptr)
+            {
+                break;
+            }
+            co_await WaitForRequest(server, player->socket);
             Action userInput = server->InterpretClientRequest(player->socket);
             switch (userInput)
             {
@@ -751,22 +887,21 @@ void RunPlayer(Game *game, Client *player, ServerConnection *server)
 *   client through.                                             *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void RunDealer(Game* game, ServerConnection *server)
+TableTask RunDealer(Game* game, ServerConnection *server)
 {
-    SendStateToAllPlayers(server, game, false, -1);
+    co_await SendStateToAllPlayers(server, game, false, -1);
     game->hasBusted = false;
     game->hasStood = false;
     // reveal hidden card
-    game->shownCards.push_back(game->hiddenCard);
-    game->hiddenCard = "";
+    game->shownCards.Add(game->hiddenCard);
+    game->hiddenCard = NO_CARD;
 
     // play game
     bool playing = true;
     do
     {
         // check if dealer has busted
-        int dealerScore = GetDealerScore(game);
-        if (dealerScore > MAX_SAFE_SCORE)
+        if (game->shownCards.IsBust())
         {
             game->hasBusted = true;
             playing = false;
@@ -775,10 +910,9 @@ void RunDealer(Game* game, ServerConnection *server)
         else
         {
             // If the dealer hasn't reched thier limit, hit
-            if (dealerScore < DEALER_STAND_ON)
+            if (game->shownCards.Score() < DEALER_STAND_ON)
             {
-                game->shownCards.push_back(game->deck[game->deckIterator]);
-                game->deckIterator++;
+                game->shownCards.Add(DrawCard(game));
             }
             // dealer stands
             else
@@ -790,6 +924,338 @@ void RunDealer(Game* game, ServerConnection *server)
     } while (playing);
 }
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                     SendStateToAllPlayers                     *
+*------------------------- Description -------------------------*
+* Send the current game state to all players in one batch. The  *
+* state is built and encoded once for the whole table. The table*
+* parks first if a player has too many states unconfirmed.      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ServerConnection *server: The server connection to talk to the*
+*   clients through.                                            *
+*                                                               *
+* Game *game: The game to send.                                 *
+*                                                               *
+* const bool isNewRound: If the state is a new round.           *
+*                                                               *
+* const int playerTurn: The index of the active player.         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+TableTask SendStateToAllPlayers(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn)
+{
+    int sockets[PLAYER_COUNT];
+    int seats[PLAYER_COUNT];
+    std::shared_ptr<Client> seated[PLAYER_COUNT];
+    int count = 0;
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+        if (game->players[i] != nullptr)
+        {
+            seated[count] = game->players[i];
+            sockets[count] = game->players[i]->socket;
+            seats[count] = i;
+            count++;
+        }
+    }
+
+    // set up one state packet for every seated player once they all have room for it
+    co_await WaitForStateWindows(server, sockets, count);
+    struct StateData state;
+    BuildStateForPlayer(game, isNewRound, playerTurn, nullptr, state);
+
+    // send state packet to clients
+    bool stillConnected[PLAYER_COUNT];
+    server->SendStateDataToPlayers(sockets, seats, state, count, stillConnected);
+    for (int i = 0; i < count; i++)
+    {
+        if (!stillConnected[i])
+        {
+            server->Unregister(seated[i]->socket);
+        }
+    }
+}
+
+/*===============================================================
+||                      Helper Functions                       ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       HandleLobbyRequest                      *
+*------------------------- Description -------------------------*
+* Handle one request from a user in the lobby. Called by a lobby*
+* thread once the user's socket has data to read. If the user   *
+* leaves the lobby, their socket is removed from the queue.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ServerConnection *server: The server connection to talk to the*
+*   client through.                                             *
+*                                                               *
+* const int eventQueue: The queue of lobby sockets.             *
+*                                                               *
+* LobbyFeed *feed: The lobby changes pushed to subscribers on   *
+*   this lobby thread.                                          *
+*                                                               *
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the user is still in the lobby.               *
+* Returns false if the user joined a game or disconnected.      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool HandleLobbyRequest(ServerConnection *server, const int eventQueue, LobbyFeed *feed, const int clientSocket)
+{
+    bool waitingOnUser = true;
+    bool disconnected = false;
+    bool isQueued = false;
+    bool isSeated = false;
+    bool noErrors;
+    Action userInput = server->InterpretClientRequest(clientSocket);
+    switch (userInput)
+    {
+        case (PROTOCOL):
+            noErrors = server->NegotiateProtocol(clientSocket);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            break;
+
+        case (LIST):
+            noErrors = server->ListGames(clientSocket);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            break;
+
+        case (SEARCH):
+            noErrors = server->SearchGames(clientSocket);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            break;
+
+        case (SUBSCRIBE):
+            noErrors = server->SubscribeToLobby(clientSocket, feed);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            break;
+        
+        case (CREATE):
+            std::cout << "Server creating game" << std::endl;
+            noErrors = server->CreateGame(clientSocket);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            if (server->GetClient(clientSocket) != nullptr)
+            {
+                server->GetClient(clientSocket)->hasCreatedGame = true;
+            }
+            break;
+
+        case (JOIN):
+        case (JOINTABLE):
+            std::cout << "Server putting Client in game" << std::endl;
+            noErrors = (userInput == JOIN) ? server->JoinGame(clientSocket, isSeated) : server->JoinTable(clientSocket, isSeated);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            // a user turned away stays in the lobby to pick another room
+            else if (isSeated)
+            {
+                waitingOnUser = false;
+            }
+            break;
+
+        case (QUICKJOIN):
+            std::cout << "Server queueing Client for matchmaking" << std::endl;
+            noErrors = server->QuickJoin(clientSocket, isQueued);
+            if (!noErrors)
+            {
+                waitingOnUser = false;
+                disconnected = true;
+            }
+            else if (isQueued)
+            {
+                waitingOnUser = false;
+            }
+            break;
+
+        case (UNREGISTER):
+            waitingOnUser = false;
+            disconnected = true;
+            break;
+
+        default:
+            break;
+    }
+
+    if (waitingOnUser)
+    {
+        return true;
+    }
+    // stop watching and pushing to the socket before it is closed or handed to a game
+    UnwatchSocket(eventQueue, clientSocket);
+    server->UnsubscribeFromLobby(clientSocket, feed);
+
+    // if the user disconnected, don't do anything
+    if(disconnected)
+    {
+        server->Unregister(clientSocket);
+        return false;
+    }
+
+    // matchmaking seats the user at a table that is already running
+    if (isQueued)
+    {
+        return false;
+    }
+
+    // if a clients makes a new room, start running the room's table
+    std::shared_ptr<Client> client = server->GetClient(clientSocket);
+    if (client != nullptr && client->hasCreatedGame)
+    {
+        RunTable(GameRoom(server->GetUserGame(clientSocket), server));
+    }
+    return false;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        StartQuickTable                        *
+*------------------------- Description -------------------------*
+* Make a warm game for matchmaking and start running its table, *
+* which waits for players to be seated.                         *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ServerConnection *server: The server connection to make the   *
+*   game through.                                               *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the new game.                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+std::shared_ptr<Game> StartQuickTable(ServerConnection *server)
+{
+    std::shared_ptr<Game> game = server->OpenQuickTable();
+    RunTable(GameRoom(game, server));
+    return game;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           ChangeShoe                          *
+*------------------------- Description -------------------------*
+* Move the table on to its spare shoe, already shuffled in the  *
+* background, and start dealing from the top.                   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Game *game: The game to change the shoe of.                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ChangeShoe(Game *game)
+{
+    game->deck = NextShoe(game->shoes);
+    game->deckIterator = 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            DrawCard                           *
+*------------------------- Description -------------------------*
+* Deal the next card, from the top of the shoe or at random from*
+* a continuous shoe.                                            *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Game *game: The game to deal from.                            *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the card dealt.                                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+Card DrawCard(Game *game)
+{
+    if (game->dealingMode == CONTINUOUS_DEALING)
+    {
+        return DrawContinuous(*game->shoes);
+    }
+    Card card = game->deck[game->deckIterator];
+    game->deckIterator++;
+    return card;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        DealCardToPlayer                       *
+*------------------------- Description -------------------------*
+* Deal a card to the player.                                    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Game *game: The game to deal from.                            *
+*                                                               *
+* Client *player: The player to deal to.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void DealCardToPlayer(Game *game, Client *player)
+{
+    player->shownCards.Add(DrawCard(game));
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        RevealHiddenCard                       *
+*------------------------- Description -------------------------*
+* Reveal the player's hidden card                               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Client *player: The player to reveal the card of.             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void RevealHiddenCard(Client *player)
+{
+    player->shownCards.Add(player->hiddenCard);
+    player->hiddenCard = NO_CARD;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       DealStartingHands                       *
+*------------------------- Description -------------------------*
+* Deal the starting hands to each player and the dealer.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Game *game: The game to deal the starting hands of.           *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void DealStartingHands(Game *game)
+{
+    // deal to players
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+        if (game->players[i] != nullptr)
+        {
+            //deal hidden card
+            game->players[i]->hiddenCard = DrawCard(game);
+
+            //deal shown card
+            DealCardToPlayer(game, game->players[i].get());
+        }
+    }
+
+    // deal to dealer
+    // deal hidden card
+    game->hiddenCard = DrawCard(game);
+
+    // deal shown card
+    game->shownCards.Add(DrawCard(game));
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                          PayoutPlayer                         *
 *------------------------- Description -------------------------*
@@ -816,12 +1282,12 @@ void PayoutPlayer(Game *game, Client *player)
         lost = false;
     }
     // if dealer and player both did not bust, and player has a lower score, no money
-    else if (GetDealerScore(game) > GetPlayerScore(player))
+    else if (game->shownCards.Score() > player->shownCards.Score())
     {
         lost = true;
     }
     // if dealer and player both did not bust, and player has better score, yay money
-    else if (GetDealerScore(game) < GetPlayerScore(player))
+    else if (game->shownCards.Score() < player->shownCards.Score())
     {
         lost = false;
     }
@@ -840,7 +1306,7 @@ void PayoutPlayer(Game *game, Client *player)
     else
     {
         //check for blackjack add an extra 50%
-        if ((GetPlayerScore(player) == MAX_SAFE_SCORE) && (player->shownCards.size() == 2))
+        if (player->shownCards.IsBlackjack())
         {
             player->money += (player->mostRecentBet / 2);
         }
@@ -849,41 +1315,35 @@ void PayoutPlayer(Game *game, Client *player)
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                       SendStateToPlayer                       *
+*                      BuildStateForPlayer                      *
 *------------------------- Description -------------------------*
-* Send the current game state to the player.                    *
+* Summarize the current game state for a player.                *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* ServerConnection *server: The server connection to talk to the*
-*   client through.                                             *
-*                                                               *
-* Game *game: The game to send.                                 *
+* Game *game: The game to summarize.                            *
 *                                                               *
 * const bool isNewRound: If the state is a new round.           *
 *                                                               *
 * const int playerTurn: The index of the active player.         *
 *                                                               *
-* Client *player: The player to send the state to.              *
+* Client *player: The player the state is for. nullptr if the   *
+*   state is shared by every player, leaving playerIndex -1.    *
 *                                                               *
-*------------------------- Return Value ------------------------*
-* Returns true if the connection to the client is still active. *
-* Returns false if the connection to the client has terminated. *
+* StateData &state: The state to fill in.                       *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-bool SendStateToPlayer(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn, Client *player)
+void BuildStateForPlayer(Game *game, const bool isNewRound, const int playerTurn, Client *player, StateData &state)
 {
-    // set up state packet
-    struct StateData state;
-
     // is new round
     state.isNewRound = isNewRound;
     // player turn
     state.playerTurn = playerTurn;
+    state.playerIndex = -1;
 
     for (int i = 0; i < PLAYER_COUNT; i++)
     {
         // player index
-        if (game->players[i] == player)
+        if (player != nullptr && game->players[i].get() == player)
         {
             state.playerIndex = i;
         }
@@ -907,7 +1367,7 @@ bool SendStateToPlayer(ServerConnection *server, Game *game, const bool isNewRou
             state.playerBets[i] = -1;
 
             // player's cards
-            state.shownCards[i] = std::vector<std::string>();
+            state.shownCards[i] = Hand();
         }
     }
 
@@ -915,19 +1375,16 @@ bool SendStateToPlayer(ServerConnection *server, Game *game, const bool isNewRou
     state.playerMoney[PLAYER_COUNT] = -1;
     state.playerBets[PLAYER_COUNT] = -1;
     state.shownCards[PLAYER_COUNT] = game->shownCards;
-
-    // send state packet to client
-    return server->SendStateData(player->socket, state);
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                     SendStateToAllPlayers                     *
+*                       SendStateToPlayer                       *
 *------------------------- Description -------------------------*
-* Send the current game state to all players.                   *
+* Send the current game state to the player.                    *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * ServerConnection *server: The server connection to talk to the*
-*   clients through.                                            *
+*   client through.                                             *
 *                                                               *
 * Game *game: The game to send.                                 *
 *                                                               *
@@ -935,18 +1392,19 @@ bool SendStateToPlayer(ServerConnection *server, Game *game, const bool isNewRou
 *                                                               *
 * const int playerTurn: The index of the active player.         *
 *                                                               *
+* Client *player: The player to send the state to.              *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void SendStateToAllPlayers(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn)
+bool SendStateToPlayer(ServerConnection *server, Game *game, const bool isNewRound, const int playerTurn, Client *player)
 {
-    for (int i = 0; i < PLAYER_COUNT; i++)
-    {
-        if (game->players[i] != nullptr)
-        {
-            bool stillConnected = SendStateToPlayer(server, game, isNewRound, playerTurn, game->players[i]);
-            if (!stillConnected)
-            {
-                server->Unregister(game->players[i]->socket);
-            }
-        }
-    }
+    // set up state packet
+    struct StateData state;
+    BuildStateForPlayer(game, isNewRound, playerTurn, player, state);
+
+    // send state packet to client
+    return server->SendStateData(player->socket, state);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ServerAPI.h"      // My H file
+#include "IoUringTransport.h" // StartIoRing, RunRingRequests
 #include <sys/types.h>      // socket, bind
 #include <sys/socket.h>     // socket, bind, listen, inet_ntoa
 #include <netinet/in.h>     // htonl, htons, inet_ntoa
@@ -7,8 +8,19 @@
 #include <unistd.h>         // read, write, close
 #include <strings.h>        // bzero
 #include <netinet/tcp.h>    // SO_REUSEADDR
+#include <sys/epoll.h>      // epoll_create1, epoll_ctl, epoll_wait
+#include <sys/timerfd.h>    // timerfd_create, timerfd_settime
+#include <sys/eventfd.h>    // eventfd
+#include <cstdint>          // uint64_t
+#include <cerrno>           // errno, EINTR
 #include <chrono>           // used for timeouts
 #include <cstring>          // strlen
+#include <algorithm>        // min
+#include <vector>           // vector
+#include <mutex>            // mutex, lock_guard
+#include <unordered_map>    // unordered_map
+#include <sys/uio.h>        // iovec
+#include <poll.h>           // poll
 //#include <iostream>         // cout (debugging)
 
 /*===============================================================
@@ -16,6 +28,395 @@
 ===============================================================*/
 const int BROADCAST_PORT = 2927;
 const int GAME_PORT = 2928;
+const int DISCOVERY_BATCH = 32;     // The most discovery probes read or answered at once
+const int DISCOVERY_REPLY_SIZE = 256;   // The size of the host name reply the client expects
+const int DISCOVERY_PROBE_SIZE = 64;    // The most bytes kept from each probe
+const int MAX_READY_EVENTS = 64;    // The most events read from an event queue at once
+const int FRAME_HEADER_SIZE = 4;    // The bytes in front of every message holding its length
+const int MAX_FRAME_SIZE = 65536;   // The largest message a client may send
+const int RECEIVE_CHUNK_SIZE = 4096;// The most bytes pulled off a socket per read
+
+/*===============================================================
+||                      Private Data Types                     ||
+===============================================================*/
+
+// The bytes read from a client that have not been handed out as messages yet
+struct ReceiveBuffer
+{
+    std::vector<char> data;     // The raw bytes read from the socket
+    size_t start = 0;           // The first byte not handed out yet
+    size_t end = 0;             // One past the last byte read
+};
+
+// How much of the next message is in a receive buffer
+enum FrameStatus {FRAME_READY, FRAME_PARTIAL, FRAME_INVALID};
+
+/*===============================================================
+||                      Private Variables                      ||
+===============================================================*/
+bool useIoRing = false;     // True: client writes go through io_uring
+
+// Each client's unread bytes. The socket is used as the key. The lock only guards
+// the map itself; a buffer is only ever touched by the thread handling its socket.
+std::mutex receiveBuffersLock;
+std::unordered_map<int, ReceiveBuffer> receiveBuffers;
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ThreadHasRing                         *
+*------------------------- Description -------------------------*
+* Checks if the calling thread should use io_uring, setting up  *
+* its ring the first time it is asked.                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if writes should use the thread's ring.          *
+* Returns false if they should use write().                     *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ThreadHasRing()
+{
+    return useIoRing && StartIoRing();
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        GetReceiveBuffer                       *
+*------------------------- Description -------------------------*
+* Find the receive buffer of a socket, making it if needed.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: The socket to find the buffer of.           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the socket's receive buffer. It stays valid until the *
+* socket is closed with CloseConnection().                      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+ReceiveBuffer& GetReceiveBuffer(const int socket)
+{
+    std::lock_guard<std::mutex> guard(receiveBuffersLock);
+    return receiveBuffers[socket];
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         CheckForFrame                         *
+*------------------------- Description -------------------------*
+* Check if a whole message is waiting in a receive buffer.      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const ReceiveBuffer &received: The buffer to check.           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns FRAME_READY if a whole message can be taken.          *
+* Returns FRAME_PARTIAL if more bytes need to be read first.    *
+* Returns FRAME_INVALID if the message is longer than allowed.  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+FrameStatus CheckForFrame(const ReceiveBuffer &received)
+{
+    size_t available = received.end - received.start;
+    if (available < FRAME_HEADER_SIZE)
+    {
+        return FRAME_PARTIAL;
+    }
+
+    uint32_t length;
+    memcpy(&length, &received.data[received.start], FRAME_HEADER_SIZE);
+    length = ntohl(length);
+    if (length > MAX_FRAME_SIZE)
+    {
+        return FRAME_INVALID;
+    }
+    if (available < FRAME_HEADER_SIZE + length)
+    {
+        return FRAME_PARTIAL;
+    }
+    return FRAME_READY;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           TakeFrame                           *
+*------------------------- Description -------------------------*
+* Move the next whole message out of a receive buffer and null  *
+* terminate it. A message longer than the buffer is cut short.  *
+* Only call once CheckForFrame() returns FRAME_READY.           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ReceiveBuffer &received: The buffer to take the message from. *
+*                                                               *
+* char buffer[]: Where the message will be placed.              *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of bytes placed in buffer, not counting the*
+* null.                                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int TakeFrame(ReceiveBuffer &received, char buffer[], const int bufferSize)
+{
+    uint32_t length;
+    memcpy(&length, &received.data[received.start], FRAME_HEADER_SIZE);
+    length = ntohl(length);
+
+    size_t copied = std::min((size_t) length, (size_t) (bufferSize - 1));
+    memcpy(buffer, &received.data[received.start + FRAME_HEADER_SIZE], copied);
+    buffer[copied] = '\0';
+
+    received.start += FRAME_HEADER_SIZE + length;
+    if (received.start == received.end)
+    {
+        received.start = 0;
+        received.end = 0;
+    }
+    return (int) copied;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        MakeRoomToRead                         *
+*------------------------- Description -------------------------*
+* Make sure a receive buffer has RECEIVE_CHUNK_SIZE free bytes  *
+* after its end, sliding unread bytes to the front first.       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ReceiveBuffer &received: The buffer to make room in.          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns where the next read should place its bytes.           *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+char* MakeRoomToRead(ReceiveBuffer &received)
+{
+    if (received.data.size() - received.end < RECEIVE_CHUNK_SIZE && received.start > 0)
+    {
+        memmove(received.data.data(), &received.data[received.start], received.end - received.start);
+        received.end -= received.start;
+        received.start = 0;
+    }
+    if (received.data.size() - received.end < RECEIVE_CHUNK_SIZE)
+    {
+        received.data.resize(received.end + RECEIVE_CHUNK_SIZE);
+    }
+    return &received.data[received.end];
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         WaitForSocket                         *
+*------------------------- Description -------------------------*
+* Wait until a non-blocking socket can be read from or written  *
+* to.                                                           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: The socket to wait on.                      *
+*                                                               *
+* const short events: POLLIN to wait to read, POLLOUT to write. *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true once the socket is ready or has an error to read.*
+* Returns false if the socket can't be waited on.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WaitForSocket(const int socket, const short events)
+{
+    pollfd waitOn;
+    waitOn.fd = socket;
+    waitOn.events = events;
+    waitOn.revents = 0;
+    int ready;
+    do
+    {
+        ready = poll(&waitOn, 1, -1);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0 && (waitOn.revents & POLLNVAL) == 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           ReadBytes                           *
+*------------------------- Description -------------------------*
+* Read whatever bytes are available from a socket, waiting for  *
+* at least one.                                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: The socket to read from.                    *
+*                                                               *
+* char buffer[]: Where the bytes will be placed.                *
+*                                                               *
+* const int bufferSize: The most bytes to read.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of bytes read. Returns 0 or less if the    *
+* connection has terminated.                                    *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+long ReadBytes(const int socket, char buffer[], const int bufferSize)
+{
+    // client sockets are non-blocking, so wait for data when there is none
+    while (true)
+    {
+        ssize_t bytes = read(socket, buffer, bufferSize);
+        if (bytes >= 0 || errno == EINTR)
+        {
+            if (bytes >= 0)
+            {
+                return bytes;
+            }
+            continue;
+        }
+        if ((errno != EAGAIN && errno != EWOULDBLOCK) || !WaitForSocket(socket, POLLIN))
+        {
+            return -1;
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         SkipSentBytes                         *
+*------------------------- Description -------------------------*
+* Move past the pieces of a gathered write that have been sent. *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* iovec *&parts: The pieces left to send. Moved forward.        *
+*                                                               *
+* int &partCount: The number of pieces left. Reduced.           *
+*                                                               *
+* size_t sent: The number of bytes that were sent.              *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SkipSentBytes(iovec *&parts, int &partCount, size_t sent)
+{
+    while (partCount > 0 && sent >= parts[0].iov_len)
+    {
+        sent -= parts[0].iov_len;
+        parts++;
+        partCount--;
+    }
+    if (partCount > 0)
+    {
+        parts[0].iov_base = (char*) parts[0].iov_base + sent;
+        parts[0].iov_len -= sent;
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         WriteAllParts                         *
+*------------------------- Description -------------------------*
+* Write every piece to a socket in order with sendmsg(),        *
+* continuing after short writes.                                *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: The socket to write to.                     *
+*                                                               *
+* iovec parts[]: The pieces to write. Changed while writing.    *
+*                                                               *
+* int partCount: The number of pieces.                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WriteAllParts(const int socket, iovec parts[], int partCount)
+{
+    while (partCount > 0)
+    {
+        msghdr message;
+        bzero((char*) &message, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = partCount;
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // the socket is non-blocking, wait for room to write
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && WaitForSocket(socket, POLLOUT))
+            {
+                continue;
+            }
+            return false;
+        }
+        SkipSentBytes(parts, partCount, sent);
+    }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SetFrameHeader                         *
+*------------------------- Description -------------------------*
+* Write the length of a message in front of it.                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* char header[]: FRAME_HEADER_SIZE bytes to write the length to.*
+*                                                               *
+* const size_t length: The length of the message.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SetFrameHeader(char header[], const size_t length)
+{
+    uint32_t networkLength = htonl((uint32_t) length);
+    memcpy(header, &networkLength, FRAME_HEADER_SIZE);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       SendPartsToClients                      *
+*------------------------- Description -------------------------*
+* Write each client's pieces to its socket. With io_uring every *
+* write is submitted in one batch.                              *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int sockets[]: The TCP sockets to send to.              *
+*                                                               *
+* iovec parts[]: The pieces to write, partsPerSocket for each   *
+*   socket in order. Changed while writing.                     *
+*                                                               *
+* const int partsPerSocket: The number of pieces per socket.    *
+*                                                               *
+* const int count: The number of sockets.                       *
+*                                                               *
+* bool stillConnected[]: Set to true for each client whose      *
+*   connection is still active, false otherwise.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SendPartsToClients(const int sockets[], iovec parts[], const int partsPerSocket, const int count, bool stillConnected[])
+{
+    if (!ThreadHasRing())
+    {
+        for (int i = 0; i < count; i++)
+        {
+            stillConnected[i] = WriteAllParts(sockets[i], &parts[i * partsPerSocket], partsPerSocket);
+        }
+        return;
+    }
+
+    std::vector<RingRequest> requests(count);
+    for (int i = 0; i < count; i++)
+    {
+        requests[i].socket = sockets[i];
+        requests[i].parts = &parts[i * partsPerSocket];
+        requests[i].partCount = partsPerSocket;
+    }
+    RunRingRequests(requests.data(), count);
+    for (int i = 0; i < count; i++)
+    {
+        if (requests[i].result == -EAGAIN)
+        {
+            requests[i].result = 0;
+        }
+        stillConnected[i] = requests[i].result >= 0;
+        if (stillConnected[i])
+        {
+            // finish anything the ring sent short
+            iovec* left = &parts[i * partsPerSocket];
+            int leftCount = partsPerSocket;
+            SkipSentBytes(left, leftCount, requests[i].result);
+            stillConnected[i] = WriteAllParts(sockets[i], left, leftCount);
+        }
+    }
+}
 
 /*===============================================================
 ||                       Public Functions                      ||
@@ -25,21 +426,30 @@ const int GAME_PORT = 2928;
 *                          StartServer                          *
 *------------------------- Description -------------------------*
 * Sets up a UDP socket on broadcastSocket used for finding      *
-* clients. Sets up a TCP socket on gameSocket used for          *
-* communicating about the game.                                 *
+* clients. The TCP sockets used for communicating about the     *
+* game are set up with StartGameSocket(). Only one server may   *
+* run on a computer, and the discovery port is what keeps a     *
+* second one out, so call this before any game socket is set    *
+* up and stop if it fails.                                      *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * int& broadcastSocket: an int that will represent the UDP      *
-*   socket after the function completes.                        *
+*   socket after the function completes, or -1 if it failed.    *
 *                                                               *
-* int& gameSocket: an int that will represent the TCP socket    *
-*   after the function completes.                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is set up. Returns false if it     *
+* could not be, such as when another server already has the     *
+* discovery port.                                               *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void StartServer(int& broadcastSocket, int& gameSocket)
+bool StartServer(int& broadcastSocket)
 {
     // --- broadcast socket ---
     broadcastSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (broadcastSocket < 0)
+    {
+        return false;
+    }
 
     int broadcastEnable = 1;
     setsockopt(broadcastSocket, SOL_SOCKET, SO_BROADCAST, &broadcastEnable, sizeof(broadcastEnable));
@@ -49,9 +459,39 @@ void StartServer(int& broadcastSocket, int& gameSocket)
     broadcastSock.sin_family = AF_INET;
     broadcastSock.sin_addr.s_addr = htonl(INADDR_ANY);
     broadcastSock.sin_port = htons(BROADCAST_PORT);
-    bind(broadcastSocket, (sockaddr*) &broadcastSock, sizeof(broadcastSock));
 
-    // --- game socket ---
+    // the port is bound without SO_REUSEPORT, so this fails with EADDRINUSE if another
+    // server is running, before it could quietly share the game port with this one
+    if (bind(broadcastSocket, (sockaddr*) &broadcastSock, sizeof(broadcastSock)) < 0)
+    {
+        close(broadcastSocket);
+        broadcastSocket = -1;
+        return false;
+    }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        StartGameSocket                        *
+*------------------------- Description -------------------------*
+* Sets up a non-blocking TCP socket listening for clients on the*
+* game port. Every game socket shares the port with             *
+* SO_REUSEPORT, so the kernel spreads new connections across    *
+* them and each can be accepted from on its own thread. As that *
+* would let a second server share the port too, only call this  *
+* once StartServer() has succeeded.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int backlog: The most connections that may wait to be   *
+*   accepted on this socket.                                    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the socket. Returns -1 if the     *
+* socket could not be set up.                                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartGameSocket(const int backlog)
+{
     // Create socket
     sockaddr_in gameSock;
     bzero((char*) &gameSock, sizeof(gameSock));  // zero out the data structure
@@ -59,86 +499,181 @@ void StartServer(int& broadcastSocket, int& gameSocket)
     gameSock.sin_addr.s_addr = htonl(INADDR_ANY); // listen on any address this computer has
     gameSock.sin_port = htons(GAME_PORT);  // set the port to listen on
     // Open a stream-oriented socket with the Internet address family
-    gameSocket = socket(AF_INET, SOCK_STREAM, 0);
+    int gameSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (gameSocket < 0)
+    {
+        return -1;
+    }
 
-    // Set the SO_REUSEADDR option
+    // Set the SO_REUSEADDR and SO_REUSEPORT options
     const int on = 1;
     setsockopt(gameSocket, SOL_SOCKET, SO_REUSEADDR, (char *) &on, sizeof(int));
+    setsockopt(gameSocket, SOL_SOCKET, SO_REUSEPORT, (char *) &on, sizeof(int));
 
-    // Bind the socket
-    bind(gameSocket, (sockaddr*) &gameSock, sizeof(gameSock));  // bind the socket using the parameters we set earlier
+    // Bind the socket and listen on it
+    if (bind(gameSocket, (sockaddr*) &gameSock, sizeof(gameSock)) < 0 || listen(gameSocket, backlog) < 0)
+    {
+        close(gameSocket);
+        return -1;
+    }
+    return gameSocket;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      UseIoUringTransport                      *
+*------------------------- Description -------------------------*
+* Switches every client write to io_uring. Each thread sets up  *
+* its own ring the first time it writes to a client, and a      *
+* thread that can't get a ring keeps using write(). Reads stay  *
+* on recv(), as a socket is only read once it is known to be    *
+* ready, so a ring has nothing to save there.                   *
+* Call once at startup before any client is accepted.           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if io_uring is available and now in use.         *
+* Returns false if io_uring is not available, in which case the *
+* server keeps using read() and write().                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool UseIoUringTransport()
+{
+    useIoRing = StartIoRing();
+    return useIoRing;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                          AcceptClient                         *
+*                     AnswerDiscoveryProbes                     *
 *------------------------- Description -------------------------*
-* Recives a connection request from a client on broadcastSocket *
-* (UDP) and replies with the Server IP. The establishes a TCP   *
-* connection with the client using the gameSocket.              *
+* Answers every client looking for the server on broadcastSocket*
+* (UDP) with the server's host name. Probes are read and        *
+* answered in batches, and the reply is made once up front.     *
+* Never returns, so run it on its own thread.                   *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int broadcastSocket: A UDP socket set up with           *
 *   StartServer().                                              *
 *                                                               *
-* const int gameSocket: A UDP socket set up with StartServer(). *
-*                                                               *
-*------------------------- Return Value ------------------------*
-* Returns an int representing the socket used to communicate    *
-* with the client.                                              *
-*                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-int AcceptClient(const int broadcastSocket, const int gameSocket)
+void AnswerDiscoveryProbes(const int broadcastSocket)
 {
-    // --- Send IP to client over UDP ---
-    bool foundClient = false;
-    char clientBuffer[1024];
-    sockaddr_in clientSock;
-    socklen_t clientSockSize = sizeof(clientSock);
-    
-    while (!foundClient)
+    // the reply never changes, so make it once
+    char reply[DISCOVERY_REPLY_SIZE];
+    bzero(reply, sizeof(reply));
+    gethostname(reply, sizeof(reply) - 1);
+
+    char probes[DISCOVERY_BATCH][DISCOVERY_PROBE_SIZE];
+    sockaddr_in senders[DISCOVERY_BATCH];
+    iovec probeParts[DISCOVERY_BATCH];
+    mmsghdr probeMessages[DISCOVERY_BATCH];
+    iovec replyParts[DISCOVERY_BATCH];
+    mmsghdr replyMessages[DISCOVERY_BATCH];
+    while (true)
     {
-        ssize_t bytesRead = recvfrom(broadcastSocket, clientBuffer, sizeof(clientBuffer), 0, (struct sockaddr*)&clientSock, &clientSockSize);
-        if (bytesRead > 0)
+        // wait for at least one probe, then take any others already waiting
+        bzero((char*) probeMessages, sizeof(probeMessages));
+        for (int i = 0; i < DISCOVERY_BATCH; i++)
         {
+            probeParts[i].iov_base = probes[i];
+            probeParts[i].iov_len = DISCOVERY_PROBE_SIZE;
+            probeMessages[i].msg_hdr.msg_iov = &probeParts[i];
+            probeMessages[i].msg_hdr.msg_iovlen = 1;
+            probeMessages[i].msg_hdr.msg_name = &senders[i];
+            probeMessages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+        }
+        int probeCount = recvmmsg(broadcastSocket, probeMessages, DISCOVERY_BATCH, MSG_WAITFORONE, nullptr);
+        if (probeCount <= 0)
+        {
+            continue;
+        }
 
-            char localHostName[256];
-            gethostname(localHostName, sizeof(localHostName));
-            sendto(broadcastSocket, localHostName, sizeof(localHostName), 0, (const sockaddr *)&clientSock, clientSockSize);
-            foundClient = true;
-
+        // answer every sender with the same reply
+        bzero((char*) replyMessages, sizeof(replyMessages));
+        for (int i = 0; i < probeCount; i++)
+        {
+            replyParts[i].iov_base = reply;
+            replyParts[i].iov_len = sizeof(reply);
+            replyMessages[i].msg_hdr.msg_iov = &replyParts[i];
+            replyMessages[i].msg_hdr.msg_iovlen = 1;
+            replyMessages[i].msg_hdr.msg_name = &senders[i];
+            replyMessages[i].msg_hdr.msg_namelen = probeMessages[i].msg_hdr.msg_namelen;
+        }
+        int replied = 0;
+        while (replied < probeCount)
+        {
+            int sent = sendmmsg(broadcastSocket, &replyMessages[replied], probeCount - replied, 0);
+            if (sent < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // skip a sender that can't be reached
+                sent = 1;
+            }
+            replied += sent;
         }
     }
+}
 
-    // --- Set up TCP communication with client ---
-    // Listen on the socket
-    int n = 4;
-    listen(gameSocket, n);
-
-    // Recive request from client
-    sockaddr_in newsock;   // place to store parameters for the new connection
-    socklen_t newsockSize = sizeof(newsock);
-    int clientSockTCP = -1;
-    while (clientSockTCP < 0)
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         AcceptClients                         *
+*------------------------- Description -------------------------*
+* Accepts every client waiting to connect on gameSocket (TCP),  *
+* without waiting for more. Clients find the server through     *
+* AnswerDiscoveryProbes(), which runs separately, so a client   *
+* that already knows the server can connect without probing.    *
+* The new sockets are non-blocking and closed on exec.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int gameSocket: A TCP socket set up with                *
+*   StartGameSocket().                                          *
+*                                                               *
+* int clientSockets[]: Where the new clients' sockets are put.  *
+*                                                               *
+* const int maxClients: The most clients to accept.             *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of clients accepted.                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int AcceptClients(const int gameSocket, int clientSockets[], const int maxClients)
+{
+    int count = 0;
+    while (count < maxClients)
     {
-        clientSockTCP = accept(gameSocket, (sockaddr *)&newsock, &newsockSize);  // grabs the new connection and assigns it a temporary socket
+        int clientSockTCP = accept4(gameSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientSockTCP < 0)
+        {
+            // keep going past signals and clients that gave up while waiting
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            // nobody else is waiting (or we're out of sockets for now)
+            break;
+        }
+        clientSockets[count] = clientSockTCP;
+        count++;
     }
-    return clientSockTCP;
+    return count;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                       ReadDataFromClient                      *
 *------------------------- Description -------------------------*
-* Reads bufferSize bytes from the socket into buffer using TCP  *
+* Reads the next message from the socket into buffer using TCP. *
+* Bytes are read in chunks and kept in the socket's receive     *
+* buffer, so a message split across reads is put back together  *
+* and messages sent back to back are handed out one at a time.  *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
-*   client about the game. Set up using AcceptClient().         *
+*   client about the game. Set up using AcceptClients().        *
 *                                                               *
-* char buffer[]: Where the data read from the client will be    *
-*   placed.                                                     *
+* char buffer[]: Where the message read from the client will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
 *                                                               *
-* const int bufferSize: The amount of bytes to read from the    *
-*   client into the buffer.                                     *
+* const int bufferSize: The size of buffer.                     *
 *                                                               *
 *------------------------- Return Value ------------------------*
 * Returns true if the connection to the client is still active. *
@@ -147,30 +682,69 @@ int AcceptClient(const int broadcastSocket, const int gameSocket)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ReadDataFromClient(const int socket, char buffer[], const int bufferSize)
 {
-    ssize_t bytes = read(socket, buffer, bufferSize - 1);
-    if (bytes > 0)
+    int length;
+    return ReadDataFromClient(socket, buffer, bufferSize, length);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       ReadDataFromClient                      *
+*------------------------- Description -------------------------*
+* Reads the next message from the socket into buffer, and says  *
+* how long it is. Used for messages that may hold a zero byte.  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   client about the game. Set up using AcceptClients().        *
+*                                                               *
+* char buffer[]: Where the message read from the client will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+* int &length: Set to the number of bytes placed in buffer, not *
+*   counting the null.                                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ReadDataFromClient(const int socket, char buffer[], const int bufferSize, int &length)
+{
+    ReceiveBuffer &received = GetReceiveBuffer(socket);
+    while (true)
     {
-        if (bytes < bufferSize)
+        FrameStatus status = CheckForFrame(received);
+        if (status == FRAME_READY)
+        {
+            length = TakeFrame(received, buffer, bufferSize);
+            return true;
+        }
+        if (status == FRAME_INVALID)
         {
-            buffer[bytes] = '\0';
+            return false;
         }
-        else
+
+        // the message isn't all here yet, read some more
+        char* readTo = MakeRoomToRead(received);
+        long bytes = ReadBytes(socket, readTo, RECEIVE_CHUNK_SIZE);
+        if (bytes <= 0)
         {
-            buffer[bufferSize - 1] = '\0';
+            return false;
         }
-        return true;
+        received.end += bytes;
     }
-    return false;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        SendDataToClient                       *
 *------------------------- Description -------------------------*
-* Sends data to the socket using a TCP connection.              *
+* Sends data to the socket as one message using a TCP           *
+* connection. The length of the data is sent in front of it.    *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
-*   client about the game. Set up using AcceptClient().         *
+*   client about the game. Set up using AcceptClients().        *
 *                                                               *
 * const char data[]: The data to send to the client.            *
 *                                                               *
@@ -181,12 +755,432 @@ bool ReadDataFromClient(const int socket, char buffer[], const int bufferSize)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool SendDataToClient(const int socket, const char data[])
 {
-    int x = write(socket, data, strlen(data) );
-    if ( x < 0 )
+    return SendDataToClient(socket, data, strlen(data));
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendDataToClient                       *
+*------------------------- Description -------------------------*
+* Sends data of a known length to the socket as one message,    *
+* without copying it. Used to send buffers built ahead of time. *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   client about the game. Set up using AcceptClients().        *
+*                                                               *
+* const char data[]: The data to send to the client.            *
+*                                                               *
+* const size_t length: The number of bytes of data to send.     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool SendDataToClient(const int socket, const char data[], const size_t length)
+{
+    char header[FRAME_HEADER_SIZE];
+    SetFrameHeader(header, length);
+    iovec parts[2];
+    parts[0].iov_base = header;
+    parts[0].iov_len = FRAME_HEADER_SIZE;
+    parts[1].iov_base = (void*) data;
+    parts[1].iov_len = length;
+
+    bool stillConnected;
+    SendPartsToClients(&socket, parts, 2, 1, &stillConnected);
+    return stillConnected;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         HasWaitingData                        *
+*------------------------- Description -------------------------*
+* Checks if a whole message from the client has already been    *
+* read off the socket. The socket will not report it as ready   *
+* again, so it must be handled before waiting on the socket.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket set up using AcceptClients().  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if ReadDataFromClient() will return a message    *
+* without reading from the socket.                              *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool HasWaitingData(const int socket)
+{
+    return CheckForFrame(GetReceiveBuffer(socket)) == FRAME_READY;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        ReadWaitingData                        *
+*------------------------- Description -------------------------*
+* Reads whatever bytes the client has sent without waiting for  *
+* more, stopping once a whole message is buffered. Used to pull *
+* data off a socket reported ready by an event queue.           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket set up using AcceptClients().  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ReadWaitingData(const int socket)
+{
+    ReceiveBuffer &received = GetReceiveBuffer(socket);
+    while (CheckForFrame(received) == FRAME_PARTIAL)
     {
-        return false;
+        char* readTo = MakeRoomToRead(received);
+        ssize_t bytes = recv(socket, readTo, RECEIVE_CHUNK_SIZE, MSG_DONTWAIT);
+        if (bytes > 0)
+        {
+            received.end += bytes;
+        }
+        else if (bytes == 0)
+        {
+            return false;
+        }
+        else if (errno != EINTR)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
     }
-    return true;
+    return CheckForFrame(received) == FRAME_READY;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       SendDataToClients                       *
+*------------------------- Description -------------------------*
+* Sends to several clients at once, the same as calling         *
+* SendDataToClient() on each. With io_uring every write is      *
+* submitted in one batch.                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int sockets[]: The TCP sockets to send to.              *
+*                                                               *
+* const char* data[]: The data to send to each client.          *
+*                                                               *
+* const int count: The number of sockets.                       *
+*                                                               *
+* bool stillConnected[]: Set to true for each client whose      *
+*   connection is still active, false otherwise.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SendDataToClients(const int sockets[], const char* data[], const int count, bool stillConnected[])
+{
+    // each message is its length header followed by the data itself
+    std::vector<char> headers(count * FRAME_HEADER_SIZE);
+    std::vector<iovec> parts(count * 2);
+    for (int i = 0; i < count; i++)
+    {
+        size_t length = strlen(data[i]);
+        SetFrameHeader(&headers[i * FRAME_HEADER_SIZE], length);
+        parts[i * 2].iov_base = &headers[i * FRAME_HEADER_SIZE];
+        parts[i * 2].iov_len = FRAME_HEADER_SIZE;
+        parts[i * 2 + 1].iov_base = (void*) data[i];
+        parts[i * 2 + 1].iov_len = length;
+    }
+    SendPartsToClients(sockets, parts.data(), 2, count, stillConnected);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       SendDataToClients                       *
+*------------------------- Description -------------------------*
+* Sends each client one message made of a head followed by a    *
+* body. The two are gathered straight from their buffers, so    *
+* clients can share one body that was only encoded once.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int sockets[]: The TCP sockets to send to.              *
+*                                                               *
+* const char* heads[]: The start of each client's message.      *
+*                                                               *
+* const size_t headLengths[]: The number of bytes of each head. *
+*                                                               *
+* const char* bodies[]: The rest of each client's message. The  *
+*   same pointer may be given for several clients.              *
+*                                                               *
+* const size_t bodyLengths[]: The number of bytes of each body. *
+*                                                               *
+* const int count: The number of sockets.                       *
+*                                                               *
+* bool stillConnected[]: Set to true for each client whose      *
+*   connection is still active, false otherwise.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SendDataToClients(const int sockets[], const char* heads[], const size_t headLengths[], const char* bodies[], const size_t bodyLengths[], const int count, bool stillConnected[])
+{
+    std::vector<char> headers(count * FRAME_HEADER_SIZE);
+    std::vector<iovec> parts(count * 3);
+    for (int i = 0; i < count; i++)
+    {
+        SetFrameHeader(&headers[i * FRAME_HEADER_SIZE], headLengths[i] + bodyLengths[i]);
+        parts[i * 3].iov_base = &headers[i * FRAME_HEADER_SIZE];
+        parts[i * 3].iov_len = FRAME_HEADER_SIZE;
+        parts[i * 3 + 1].iov_base = (void*) heads[i];
+        parts[i * 3 + 1].iov_len = headLengths[i];
+        parts[i * 3 + 2].iov_base = (void*) bodies[i];
+        parts[i * 3 + 2].iov_len = bodyLengths[i];
+    }
+    SendPartsToClients(sockets, parts.data(), 3, count, stillConnected);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        StartEventQueue                        *
+*------------------------- Description -------------------------*
+* Creates an epoll event queue used to wait on many client      *
+* sockets at once without a thread per socket.                  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the event queue. Returns -1 if the*
+* queue could not be created.                                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartEventQueue()
+{
+    return epoll_create1(EPOLL_CLOEXEC);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           StartTimer                          *
+*------------------------- Description -------------------------*
+* Creates a timer that can be waited on in an event queue with  *
+* WatchListener(). It only goes off once SetTimer() is called.  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the timer. Returns -1 if the timer*
+* could not be created.                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartTimer()
+{
+    return timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            SetTimer                           *
+*------------------------- Description -------------------------*
+* Makes a timer go off once after a delay, replacing any delay  *
+* it was already set to. Safe to call from any thread.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int timer: A timer set up with StartTimer().            *
+*                                                               *
+* const int milliseconds: How long until the timer goes off.    *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SetTimer(const int timer, const int milliseconds)
+{
+    itimerspec delay;
+    bzero((char*) &delay, sizeof(delay));
+    delay.it_value.tv_sec = milliseconds / 1000;
+    delay.it_value.tv_nsec = (milliseconds % 1000) * 1000000L;
+    timerfd_settime(timer, 0, &delay, NULL);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           ClearTimer                          *
+*------------------------- Description -------------------------*
+* Marks a timer that went off as handled, so it is not reported *
+* by WaitForReadySockets() again until it next goes off.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int timer: A timer set up with StartTimer().            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClearTimer(const int timer)
+{
+    uint64_t expirations;
+    while (read(timer, &expirations, sizeof(expirations)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          StartSignal                          *
+*------------------------- Description -------------------------*
+* Creates a signal one thread can sleep on with WaitForSignal() *
+* until another raises it with RaiseSignal().                   *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the signal. Returns -1 if the     *
+* signal could not be created.                                  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartSignal()
+{
+    return eventfd(0, EFD_CLOEXEC);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          RaiseSignal                          *
+*------------------------- Description -------------------------*
+* Wakes the thread waiting on a signal, or the next one to wait *
+* on it if none is waiting yet. Raising it again before it is   *
+* waited on wakes the waiter only once. Safe to call from any   *
+* thread.                                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int signal: A signal set up with StartSignal().         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void RaiseSignal(const int signal)
+{
+    uint64_t raised = 1;
+    while (write(signal, &raised, sizeof(raised)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         WaitForSignal                         *
+*------------------------- Description -------------------------*
+* Sleeps until a signal has been raised, then lowers it again.  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int signal: A signal set up with StartSignal().         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void WaitForSignal(const int signal)
+{
+    uint64_t raised;
+    while (read(signal, &raised, sizeof(raised)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          WatchSocket                          *
+*------------------------- Description -------------------------*
+* Adds a socket to the event queue. The socket is reported once *
+* when it has data to read (or has closed) and is then disarmed *
+* until RewatchSocket() is called, so only one thread ever      *
+* handles a given socket at a time.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int socket: The socket to watch.                        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is now being watched.              *
+* Returns false if the socket could not be added.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WatchSocket(const int eventQueue, const int socket)
+{
+    epoll_event event;
+    bzero((char*) &event, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.fd = socket;
+    return epoll_ctl(eventQueue, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         WatchListener                         *
+*------------------------- Description -------------------------*
+* Adds a game socket or timer to the event queue. Unlike        *
+* WatchSocket(), it keeps being reported for as long as clients *
+* are waiting to be accepted or the timer has gone off, so it   *
+* never needs to be rewatched.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int gameSocket: A TCP socket set up with                *
+*   StartGameSocket(), or a timer set up with StartTimer().     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is now being watched.              *
+* Returns false if the socket could not be added.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WatchListener(const int eventQueue, const int gameSocket)
+{
+    epoll_event event;
+    bzero((char*) &event, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = gameSocket;
+    return epoll_ctl(eventQueue, EPOLL_CTL_ADD, gameSocket, &event) == 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         RewatchSocket                         *
+*------------------------- Description -------------------------*
+* Re-arms a socket that was reported by WaitForReadySockets()   *
+* so it will be reported the next time it has data to read.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int socket: The socket to watch again.                  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is now being watched.              *
+* Returns false if the socket could not be re-armed.            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool RewatchSocket(const int eventQueue, const int socket)
+{
+    epoll_event event;
+    bzero((char*) &event, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.fd = socket;
+    return epoll_ctl(eventQueue, EPOLL_CTL_MOD, socket, &event) == 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         UnwatchSocket                         *
+*------------------------- Description -------------------------*
+* Removes a socket from the event queue.                        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int socket: The socket to stop watching.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void UnwatchSocket(const int eventQueue, const int socket)
+{
+    epoll_ctl(eventQueue, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      WaitForReadySockets                      *
+*------------------------- Description -------------------------*
+* Blocks until at least one watched socket has data to read.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* int readySockets[]: Where the ready sockets will be placed.   *
+*                                                               *
+* const int maxSockets: The size of readySockets.               *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of sockets placed in readySockets.         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int WaitForReadySockets(const int eventQueue, int readySockets[], const int maxSockets)
+{
+    epoll_event events[MAX_READY_EVENTS];
+    int count = -1;
+    while (count < 0)
+    {
+        count = epoll_wait(eventQueue, events, std::min(maxSockets, MAX_READY_EVENTS), -1);
+        if (count < 0 && errno != EINTR)
+        {
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        readySockets[i] = events[i].data.fd;
+    }
+    return count;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -201,5 +1195,10 @@ bool SendDataToClient(const int socket, const char data[])
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 void CloseConnection(const int socket)
 {
+    // drop unread bytes first so a new socket given the same number starts clean
+    {
+        std::lock_guard<std::mutex> guard(receiveBuffersLock);
+        receiveBuffers.erase(socket);
+    }
     close(socket);
 }
\ No newline at end of file
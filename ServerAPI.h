@@ -1,5 +1,6 @@
 #ifndef SERVERAPI_H
 #define SERVERAPI_H
+#include <cstddef>          // size_t
 
 /*===============================================================
 ||                       Public Functions                      ||
@@ -9,53 +10,117 @@
 *                          StartServer                          *
 *------------------------- Description -------------------------*
 * Sets up a UDP socket on broadcastSocket used for finding      *
-* clients. Sets up a TCP socket on gameSocket used for          *
-* communicating about the game.                                 *
+* clients. The TCP sockets used for communicating about the     *
+* game are set up with StartGameSocket(). Only one server may   *
+* run on a computer, and the discovery port is what keeps a     *
+* second one out, so call this before any game socket is set    *
+* up and stop if it fails.                                      *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * int& broadcastSocket: an int that will represent the UDP      *
-*   socket after the function completes.                        *
+*   socket after the function completes, or -1 if it failed.    *
 *                                                               *
-* int& gameSocket: an int that will represent the TCP socket    *
-*   after the function completes.                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is set up. Returns false if it     *
+* could not be, such as when another server already has the     *
+* discovery port.                                               *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void StartServer(int& broadcastSocket, int& gameSocket);
+bool StartServer(int& broadcastSocket);
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                          AcceptClient                         *
+*                        StartGameSocket                        *
 *------------------------- Description -------------------------*
-* Recives a connection request from a client on broadcastSocket *
-* (UDP) and replies with the Server IP. The establishes a TCP   *
-* connection with the client using the gameSocket.              *
+* Sets up a non-blocking TCP socket listening for clients on the*
+* game port. Every game socket shares the port with             *
+* SO_REUSEPORT, so the kernel spreads new connections across    *
+* them and each can be accepted from on its own thread. As that *
+* would let a second server share the port too, only call this  *
+* once StartServer() has succeeded.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int backlog: The most connections that may wait to be   *
+*   accepted on this socket.                                    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the socket. Returns -1 if the     *
+* socket could not be set up.                                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartGameSocket(const int backlog);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      UseIoUringTransport                      *
+*------------------------- Description -------------------------*
+* Switches every client write to io_uring. Each thread sets up  *
+* its own ring the first time it writes to a client, and a      *
+* thread that can't get a ring keeps using write(). Reads stay  *
+* on recv(), as a socket is only read once it is known to be    *
+* ready, so a ring has nothing to save there.                   *
+* Call once at startup before any client is accepted.           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if io_uring is available and now in use.         *
+* Returns false if io_uring is not available, in which case the *
+* server keeps using read() and write().                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool UseIoUringTransport();
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                     AnswerDiscoveryProbes                     *
+*------------------------- Description -------------------------*
+* Answers every client looking for the server on broadcastSocket*
+* (UDP) with the server's host name. Probes are read and        *
+* answered in batches, and the reply is made once up front.     *
+* Never returns, so run it on its own thread.                   *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int broadcastSocket: A UDP socket set up with           *
 *   StartServer().                                              *
 *                                                               *
-* const int gameSocket: A UDP socket set up with StartServer(). *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void AnswerDiscoveryProbes(const int broadcastSocket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         AcceptClients                         *
+*------------------------- Description -------------------------*
+* Accepts every client waiting to connect on gameSocket (TCP),  *
+* without waiting for more. Clients find the server through     *
+* AnswerDiscoveryProbes(), which runs separately, so a client   *
+* that already knows the server can connect without probing.    *
+* The new sockets are non-blocking and closed on exec.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int gameSocket: A TCP socket set up with                *
+*   StartGameSocket().                                          *
+*                                                               *
+* int clientSockets[]: Where the new clients' sockets are put.  *
+*                                                               *
+* const int maxClients: The most clients to accept.             *
 *                                                               *
 *------------------------- Return Value ------------------------*
-* Returns an int representing the socket used to communicate    *
-* with the client.                                              *
+* Returns the number of clients accepted.                       *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-int AcceptClient(const int broadcastSocket, const int gameSocket);
+int AcceptClients(const int gameSocket, int clientSockets[], const int maxClients);
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                       ReadDataFromClient                      *
 *------------------------- Description -------------------------*
-* Reads bufferSize bytes from the socket into buffer using TCP  *
+* Reads the next message from the socket into buffer using TCP. *
+* Bytes are read in chunks and kept in the socket's receive     *
+* buffer, so a message split across reads is put back together  *
+* and messages sent back to back are handed out one at a time.  *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
-*   client about the game. Set up using AcceptClient().         *
+*   client about the game. Set up using AcceptClients().        *
 *                                                               *
-* char buffer[]: Where the data read from the client will be    *
-*   placed.                                                     *
+* char buffer[]: Where the message read from the client will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
 *                                                               *
-* const int bufferSize: The amount of bytes to read from the    *
-*   client into the buffer.                                     *
+* const int bufferSize: The size of buffer.                     *
 *                                                               *
 *------------------------- Return Value ------------------------*
 * Returns true if the connection to the client is still active. *
@@ -64,14 +129,40 @@ int AcceptClient(const int broadcastSocket, const int gameSocket);
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ReadDataFromClient(const int socket, char buffer[], const int bufferSize);
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       ReadDataFromClient                      *
+*------------------------- Description -------------------------*
+* Reads the next message from the socket into buffer, and says  *
+* how long it is. Used for messages that may hold a zero byte.  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   client about the game. Set up using AcceptClients().        *
+*                                                               *
+* char buffer[]: Where the message read from the client will be *
+*   placed. Null terminated, and cut short if it doesn't fit.   *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+* int &length: Set to the number of bytes placed in buffer, not *
+*   counting the null.                                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ReadDataFromClient(const int socket, char buffer[], const int bufferSize, int &length);
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        SendDataToClient                       *
 *------------------------- Description -------------------------*
-* Sends data to the socket using a TCP connection.              *
+* Sends data to the socket as one message using a TCP           *
+* connection. The length of the data is sent in front of it.    *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int socket: A TCP socket used to comunicate with the    *
-*   client about the game. Set up using AcceptClient().         *
+*   client about the game. Set up using AcceptClients().        *
 *                                                               *
 * const char data[]: The data to send to the client.            *
 *                                                               *
@@ -82,6 +173,288 @@ bool ReadDataFromClient(const int socket, char buffer[], const int bufferSize);
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool SendDataToClient(const int, const char[]);
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendDataToClient                       *
+*------------------------- Description -------------------------*
+* Sends data of a known length to the socket as one message,    *
+* without copying it. Used to send buffers built ahead of time. *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket used to comunicate with the    *
+*   client about the game. Set up using AcceptClients().        *
+*                                                               *
+* const char data[]: The data to send to the client.            *
+*                                                               *
+* const size_t length: The number of bytes of data to send.     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool SendDataToClient(const int socket, const char data[], const size_t length);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         HasWaitingData                        *
+*------------------------- Description -------------------------*
+* Checks if a whole message from the client has already been    *
+* read off the socket. The socket will not report it as ready   *
+* again, so it must be handled before waiting on the socket.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket set up using AcceptClients().  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if ReadDataFromClient() will return a message    *
+* without reading from the socket.                              *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool HasWaitingData(const int socket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        ReadWaitingData                        *
+*------------------------- Description -------------------------*
+* Reads whatever bytes the client has sent without waiting for  *
+* more, stopping once a whole message is buffered. Used to pull *
+* data off a socket reported ready by an event queue.           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int socket: A TCP socket set up using AcceptClients().  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ReadWaitingData(const int socket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       SendDataToClients                       *
+*------------------------- Description -------------------------*
+* Sends to several clients at once, the same as calling         *
+* SendDataToClient() on each. With io_uring every write is      *
+* submitted in one batch.                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int sockets[]: The TCP sockets to send to.              *
+*                                                               *
+* const char* data[]: The data to send to each client.          *
+*                                                               *
+* const int count: The number of sockets.                       *
+*                                                               *
+* bool stillConnected[]: Set to true for each client whose      *
+*   connection is still active, false otherwise.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SendDataToClients(const int sockets[], const char* data[], const int count, bool stillConnected[]);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       SendDataToClients                       *
+*------------------------- Description -------------------------*
+* Sends each client one message made of a head followed by a    *
+* body. The two are gathered straight from their buffers, so    *
+* clients can share one body that was only encoded once.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int sockets[]: The TCP sockets to send to.              *
+*                                                               *
+* const char* heads[]: The start of each client's message.      *
+*                                                               *
+* const size_t headLengths[]: The number of bytes of each head. *
+*                                                               *
+* const char* bodies[]: The rest of each client's message. The  *
+*   same pointer may be given for several clients.              *
+*                                                               *
+* const size_t bodyLengths[]: The number of bytes of each body. *
+*                                                               *
+* const int count: The number of sockets.                       *
+*                                                               *
+* bool stillConnected[]: Set to true for each client whose      *
+*   connection is still active, false otherwise.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SendDataToClients(const int sockets[], const char* heads[], const size_t headLengths[], const char* bodies[], const size_t bodyLengths[], const int count, bool stillConnected[]);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        StartEventQueue                        *
+*------------------------- Description -------------------------*
+* Creates an epoll event queue used to wait on many client      *
+* sockets at once without a thread per socket.                  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the event queue. Returns -1 if the*
+* queue could not be created.                                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartEventQueue();
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           StartTimer                          *
+*------------------------- Description -------------------------*
+* Creates a timer that can be waited on in an event queue with  *
+* WatchListener(). It only goes off once SetTimer() is called.  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the timer. Returns -1 if the timer*
+* could not be created.                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartTimer();
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            SetTimer                           *
+*------------------------- Description -------------------------*
+* Makes a timer go off once after a delay, replacing any delay  *
+* it was already set to. Safe to call from any thread.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int timer: A timer set up with StartTimer().            *
+*                                                               *
+* const int milliseconds: How long until the timer goes off.    *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void SetTimer(const int timer, const int milliseconds);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           ClearTimer                          *
+*------------------------- Description -------------------------*
+* Marks a timer that went off as handled, so it is not reported *
+* by WaitForReadySockets() again until it next goes off.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int timer: A timer set up with StartTimer().            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ClearTimer(const int timer);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          StartSignal                          *
+*------------------------- Description -------------------------*
+* Creates a signal one thread can sleep on with WaitForSignal() *
+* until another raises it with RaiseSignal().                   *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns an int representing the signal. Returns -1 if the     *
+* signal could not be created.                                  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int StartSignal();
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          RaiseSignal                          *
+*------------------------- Description -------------------------*
+* Wakes the thread waiting on a signal, or the next one to wait *
+* on it if none is waiting yet. Raising it again before it is   *
+* waited on wakes the waiter only once. Safe to call from any   *
+* thread.                                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int signal: A signal set up with StartSignal().         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void RaiseSignal(const int signal);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         WaitForSignal                         *
+*------------------------- Description -------------------------*
+* Sleeps until a signal has been raised, then lowers it again.  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int signal: A signal set up with StartSignal().         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void WaitForSignal(const int signal);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          WatchSocket                          *
+*------------------------- Description -------------------------*
+* Adds a socket to the event queue. The socket is reported once *
+* when it has data to read (or has closed) and is then disarmed *
+* until RewatchSocket() is called, so only one thread ever      *
+* handles a given socket at a time.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int socket: The socket to watch.                        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is now being watched.              *
+* Returns false if the socket could not be added.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WatchSocket(const int eventQueue, const int socket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         WatchListener                         *
+*------------------------- Description -------------------------*
+* Adds a game socket or timer to the event queue. Unlike        *
+* WatchSocket(), it keeps being reported for as long as clients *
+* are waiting to be accepted or the timer has gone off, so it   *
+* never needs to be rewatched.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int gameSocket: A TCP socket set up with                *
+*   StartGameSocket(), or a timer set up with StartTimer().     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is now being watched.              *
+* Returns false if the socket could not be added.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool WatchListener(const int eventQueue, const int gameSocket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         RewatchSocket                         *
+*------------------------- Description -------------------------*
+* Re-arms a socket that was reported by WaitForReadySockets()   *
+* so it will be reported the next time it has data to read.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int socket: The socket to watch again.                  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is now being watched.              *
+* Returns false if the socket could not be re-armed.            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool RewatchSocket(const int eventQueue, const int socket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         UnwatchSocket                         *
+*------------------------- Description -------------------------*
+* Removes a socket from the event queue.                        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* const int socket: The socket to stop watching.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void UnwatchSocket(const int eventQueue, const int socket);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      WaitForReadySockets                      *
+*------------------------- Description -------------------------*
+* Blocks until at least one watched socket has data to read.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int eventQueue: A queue set up with StartEventQueue().  *
+*                                                               *
+* int readySockets[]: Where the ready sockets will be placed.   *
+*                                                               *
+* const int maxSockets: The size of readySockets.               *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of sockets placed in readySockets.         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int WaitForReadySockets(const int eventQueue, int readySockets[], const int maxSockets);
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                        CloseConnection                        *
 *------------------------- Description -------------------------*
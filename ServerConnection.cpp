@@ -6,6 +6,10 @@
 #include <iostream>
 #include <stdio.h>
 #include <cstring>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <random>
 
 /*===============================================================
 ||                      Private Functions                      ||
@@ -14,63 +18,298 @@
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                       NextOpenSeatInRoom                      *
 *------------------------- Description -------------------------*
-* Given a room name, get the next open seat index.              *
+* Given a room, get the next open seat index. Call while holding*
+* the room's seat lock.                                         *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* const std::string name: The name of the room to check.        *
+* const Game &game: The room to check.                          *
 *                                                               *
 *------------------------- Return Value ------------------------*
 * Return the index of the next open seat. Returns -1 if there   *
-* are no open seats, if the room is closed, or if the room      *
-* doesn't exist.                                                *
+* are no open seats or if the room is closed.                   *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-int ServerConnection::NextOpenSeatInRoom(const std::string name)
+int ServerConnection::NextOpenSeatInRoom(const Game &game)
 {
-    if (DoesGameExist(name))
+    if(game.isOpen)
     {
-        if(games[name].isOpen)
+        for (int i = 0; i < PLAYER_COUNT; i++)
         {
-            for (int i = 0; i < PLAYER_COUNT; i++)
+            if(game.players[i] == nullptr)
             {
-                if(games[name].players[i] == nullptr)
-                {
-                    return i;
-                }
+                return i;
             }
         }
     }
     return -1;
 }
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SeatsTakenInRoom                       *
+*------------------------- Description -------------------------*
+* Given a room, count the players seated in it. Call while      *
+* holding the room's seat lock.                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Game &game: The room to check.                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Return the number of seats taken.                             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::SeatsTakenInRoom(const Game &game)
+{
+    int taken = 0;
+    for (int i = 0; i < PLAYER_COUNT; i++)
+    {
+        if(game.players[i] != nullptr)
+        {
+            taken++;
+        }
+    }
+    return taken;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           SeatClient                          *
+*------------------------- Description -------------------------*
+* Give the client the next open seat in a room, if it has one,  *
+* so two clients can't take the same seat. Does not tell the    *
+* client or wake the table.                                     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::shared_ptr<Client> &client: The client to seat.    *
+*                                                               *
+* const std::shared_ptr<Game> &game: The room to seat them in.  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the client was seated.                        *
+* Returns false if the room has no open seat.                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::SeatClient(const std::shared_ptr<Client> &client, const std::shared_ptr<Game> &game)
+{
+    std::lock_guard<std::mutex> guard(game->seatEvents.lock);
+    int nextSeat = NextOpenSeatInRoom(*game);
+    if (nextSeat == -1)
+    {
+        return false;
+    }
+    client->curGame = game;
+    client->isSeatAnswered = false;
+    client->needsFullState = true;
+    game->players[nextSeat] = client;
+    UpdateLobby(*game);
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            JoinRoom                           *
+*------------------------- Description -------------------------*
+* Seat the client in the room they asked to join, tell them if  *
+* they were seated, and wake the room's table.                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* const std::shared_ptr<Game> &game: The room asked for. nullptr*
+*   if no room matched the request.                             *
+*                                                               *
+* bool &isSeated: Set to true if the client was given a seat,   *
+*   and has left the lobby.                                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::JoinRoom(const int clientSocket, const std::shared_ptr<Game> &game, bool &isSeated)
+{
+    // take the next open seat, if the room has one
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    bool validRoom = (game != nullptr) && (client != nullptr) && SeatClient(client, game);
+    isSeated = validRoom;
+
+    // let the client know, then wake the table. If the client is gone,
+    // Unregister() frees the seat
+    if(validRoom)
+    {
+        bool hasSucceeded = SendAnswer(clientSocket, true);
+        std::lock_guard<std::mutex> guard(game->seatEvents.lock);
+        client->isSeatAnswered = hasSucceeded;
+        WakeTable(game->seatEvents.waitingTable);
+        return hasSucceeded;
+    }
+    // let the client know the room is not valid
+    else
+    {
+        SendAnswer(clientSocket, false);
+        return true;
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            AddGame                            *
+*------------------------- Description -------------------------*
+* Give a new game the next table id and start hosting it, unless*
+* its name is already taken.                                    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::shared_ptr<Game> &game: The game to add. Its name  *
+*   must be set.                                                *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the game was added.                           *
+* Returns false if another game has the name.                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::AddGame(const std::shared_ptr<Game> &game)
+{
+    // claim the name first, so two clients can't make the same room
+    std::shared_ptr<int> tableId = std::make_shared<int>(++tableCount);
+    if (tableIds.Insert(game->name, tableId) == nullptr)
+    {
+        return false;
+    }
+    game->id = *tableId;
+    GiveStream(*game);
+    games.Insert(game->id, game);
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           GiveStream                          *
+*------------------------- Description -------------------------*
+* Give a new game the next random stream to shuffle with and    *
+* how to deal, log it if seeds are being logged, and queue its  *
+* first shoe if it deals from shoes.                            *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Game &game: The game to give the stream. Its table id must be *
+*   set.                                                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::GiveStream(Game &game)
+{
+    std::lock_guard<std::mutex> guard(streamLock);
+    game.shoes->random = nextStream;
+    game.dealingMode = dealingMode;
+    game.randomStream = streamCount++;
+    nextStream.Jump();
+    if (isLoggingSeeds)
+    {
+        std::cout << "Table " << game.id << " (" << game.name << ") stream " << game.randomStream << std::endl;
+    }
+
+    // shuffle the first shoe before anyone sits
+    if (game.dealingMode == SHOE_DEALING)
+    {
+        PrepareShoe(game.shoes);
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           RemoveGame                          *
+*------------------------- Description -------------------------*
+* Stop hosting a game, freeing its name for a new game.         *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Game &game: The game to remove.                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::RemoveGame(const Game &game)
+{
+    // the id goes first, so the name never leads to a game that is gone
+    games.Erase(game.id);
+    tableIds.Erase(game.name);
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                         GetListOfGames                        *
 *------------------------- Description -------------------------*
-* Get a list of each open game name.                            *
+* Get a list of the first LOBBY_PAGE_SIZE open game names, in   *
+* name order. Call while holding lobbyIndexLock.                *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * std::string &list: The string to replace with the list of open*
 *   games, formatted for the client to list. If no games are    *
-*   present, sets the string to: "<no games>\n"                 *
+*   open, sets the string to: "<no games>\n"                    *
+*                                                               *
+* std::string &subscription: The string to add the same games   *
+*   and their seats taken to, one per line, as sent to new lobby*
+*   subscribers.                                                *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-void ServerConnection::GetListOfGames(std::string &list)
+void ServerConnection::GetListOfGames(std::string &list, std::string &subscription)
 {
     list = "";
-    if (games.empty())
+    int listed = 0;
+    for (auto game = lobbyIndex.begin(); game != lobbyIndex.end() && listed < LOBBY_PAGE_SIZE; ++game, listed++)
+    {
+        list += game->first;
+        list += '\n';
+
+        subscription += GAME_LISTED;
+        subscription += std::to_string(game->second.seatsTaken);
+        subscription += ' ';
+        subscription += game->first;
+        subscription += '\n';
+    }
+    if (listed == 0)
     {
         list = "<no games>\n";
-        return;
     }
+}
 
-    for (auto g : games)
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         GetPageOfGames                        *
+*------------------------- Description -------------------------*
+* Get up to LOBBY_PAGE_SIZE open games whose names start with a *
+* prefix, in name order. Call while holding lobbyIndexLock.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string &prefix: What each name must start with.    *
+*                                                               *
+* const bool freeSeatsOnly: True: Skip games with no free seat. *
+*                                                               *
+* const std::string &after: Start after this name. Empty to     *
+*   start at the first match.                                   *
+*                                                               *
+* std::string &page: The string to add each game's seats taken, *
+*   table id and name to, one per line.                         *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the name to start the next page after. Returns an     *
+* empty string if this is the last page.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+std::string ServerConnection::GetPageOfGames(const std::string &prefix, const bool freeSeatsOnly, const std::string &after, std::string &page)
+{
+    // names sharing a prefix sit next to each other in the index, starting at the prefix itself
+    auto game = (after < prefix) ? lobbyIndex.lower_bound(prefix) : lobbyIndex.upper_bound(after);
+    int listed = 0;
+    std::string lastListed;
+    for (; game != lobbyIndex.end() && game->first.compare(0, prefix.size(), prefix) == 0; ++game)
     {
-        if (g.second.isOpen)
+        if (freeSeatsOnly && game->second.seatsTaken >= PLAYER_COUNT)
         {
-            list += g.first;
-            list += '\n';
+            continue;
         }
+        // only say there is a next page if something is on it
+        if (listed == LOBBY_PAGE_SIZE)
+        {
+            return lastListed;
+        }
+        page += std::to_string(game->second.seatsTaken);
+        page += ' ';
+        page += std::to_string(game->second.tableId);
+        page += ' ';
+        page += game->first;
+        page += '\n';
+        lastListed = game->first;
+        listed++;
     }
+    return "";
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -88,101 +327,906 @@ void ServerConnection::GetListOfGames(std::string &list)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ServerConnection::DoesGameExist(const std::string name)
 {
-    for (auto g : games)
-    {
-        if(name.compare(g.first) == 0)
-        {
-            return true;
-        }
-    }
-    return false;
+    return tableIds.Find(name) != nullptr;
 }
 
-/*===============================================================
-||                       Public Functions                      ||
-===============================================================*/
-
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                          Constructor                          *
+*                        EncodeStateHeader                      *
 *------------------------- Description -------------------------*
-* Set up the server's UDP and TCP sockets                       *
+* Format the part of a state frame that differs per client: the *
+* sequence number, the kind of frame, and for a whole state the *
+* index of the player it is sent to.                            *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int sequence: The number of this state for the client.  *
+*                                                               *
+* const bool isFullState: True: The body is the whole state;    *
+*   False: The body is what changed since the last state.       *
+*                                                               *
+* const int playerIndex: The index of the client's seat.        *
+*                                                               *
+* std::string &data: The string to replace with the header.     *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-ServerConnection::ServerConnection()
+void ServerConnection::EncodeStateHeader(const int sequence, const bool isFullState, const int playerIndex, std::string &data)
 {
-    StartServer(udpConnection, tcpConnection);
+    char endOfItem = '_';
+    data = "";
+
+    // send sequence
+    data += std::to_string(sequence);
+    data += endOfItem;
+
+    // send kind of frame, and playerIndex if it's the whole state
+    if (isFullState)
+    {
+        data += FULL_STATE;
+        data += endOfItem;
+        data += std::to_string(playerIndex);
+        data += endOfItem;
+    }
+    else
+    {
+        data += CHANGED_STATE;
+        data += endOfItem;
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                          Destructor                           *
+*                        EncodeStateData                        *
 *------------------------- Description -------------------------*
-* Close each client's connection, the UDP socket, and the TCP   *
-* soket                                                         *
+* Format a game state the way the client expects to read it.    *
+* The player index is left to EncodeStateHeader(), so one body  *
+* can be sent to every seat.                                    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const StateData &state: The state of the game.                *
+*                                                               *
+* std::string &data: The string to replace with the formatted   *
+*   state.                                                      *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-ServerConnection::~ServerConnection()
+void ServerConnection::EncodeStateData(const StateData &state, std::string &data)
 {
-    // close client sockets
-    for (auto c : clients)
+    char endOfItem = '_';
+    data = "";
+
+    //send playerTurn
+    data += std::to_string(state.playerTurn);
+    data += endOfItem;
+
+    //send newRound
+    if(state.isNewRound)
+    {
+        data += "1";
+        data += endOfItem;
+    }
+    else
     {
-        CloseConnection(c.second.socket);
+        data += "0";
+        data += endOfItem;
     }
 
-    //close server sockets
-    CloseConnection(udpConnection);
-    udpConnection = -1;
-    CloseConnection(tcpConnection);
-    tcpConnection = -1;
+    //send player money
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        data += std::to_string(state.playerMoney[i]);
+        data += endOfItem;
+    }
+
+    //send player bets
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        data += std::to_string(state.playerBets[i]);
+        data += endOfItem;
+    }
+
+    //send player hands
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        //send number of cards
+        data += std::to_string(state.shownCards[i].Size());
+        data += endOfItem;
+        // send each card
+        for(int j = 0; j < state.shownCards[i].Size(); j++)
+        {
+            data += CardName(state.shownCards[i].CardAt(j));
+            data += endOfItem;
+        }
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                        AcceptNewClient                        *
+*                        EncodeStateChanges                     *
 *------------------------- Description -------------------------*
-* Look for a client to connect to the server.                   *
+* Format only what changed between two game states: the turn,   *
+* the new round flag, then each seat whose money or bet changed,*
+* each card added to a hand, and each hand that was replaced.   *
 *                                                               *
-*------------------------- Return Value ------------------------*
-* Return an int representing the client connection.             *
+*------------------------- Parameters --------------------------*
+* const StateData &previous: The state the client already has.  *
+*                                                               *
+* const StateData &state: The state of the game.                *
+*                                                               *
+* std::string &data: The string to replace with the formatted   *
+*   changes.                                                    *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-int ServerConnection::AcceptNewClient()
+void ServerConnection::EncodeStateChanges(const StateData &previous, const StateData &state, std::string &data)
 {
-    Client newClient;
-    newClient.socket = AcceptClient(udpConnection, tcpConnection);
-    clients[newClient.socket] = newClient;
-    return newClient.socket;
+    char endOfItem = '_';
+    data = "";
+
+    //send playerTurn
+    data += std::to_string(state.playerTurn);
+    data += endOfItem;
+
+    //send newRound
+    data += state.isNewRound ? "1" : "0";
+    data += endOfItem;
+
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        //send changed money
+        if (state.playerMoney[i] != previous.playerMoney[i])
+        {
+            data += "M";
+            data += std::to_string(i);
+            data += endOfItem;
+            data += std::to_string(state.playerMoney[i]);
+            data += endOfItem;
+        }
+
+        //send changed bet
+        if (state.playerBets[i] != previous.playerBets[i])
+        {
+            data += "B";
+            data += std::to_string(i);
+            data += endOfItem;
+            data += std::to_string(state.playerBets[i]);
+            data += endOfItem;
+        }
+
+        // send only the new cards if the hand grew, otherwise the whole hand
+        const Hand &oldHand = previous.shownCards[i];
+        const Hand &newHand = state.shownCards[i];
+        if (newHand == oldHand)
+        {
+            continue;
+        }
+        int firstCard = 0;
+        if (newHand.Size() > oldHand.Size() && newHand.StartsWith(oldHand))
+        {
+            data += "C";
+            firstCard = oldHand.Size();
+        }
+        else
+        {
+            data += "H";
+        }
+        data += std::to_string(i);
+        data += endOfItem;
+        data += std::to_string(newHand.Size() - firstCard);
+        data += endOfItem;
+        for(int j = firstCard; j < newHand.Size(); j++)
+        {
+            data += CardName(newHand.CardAt(j));
+            data += endOfItem;
+        }
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                     InterpretClientRequest                    *
+*                      EncodeStateHeaderCodes                   *
 *------------------------- Description -------------------------*
-* Given a client connection, wait until they send an action     *
-* code. Interpret the code and return what action was requested.*
+* Format the header EncodeStateHeader() makes, for protocol 2:  *
+* the frame code, the sequence number as an integer, and for a  *
+* whole state the player's seat as one byte.                    *
 *                                                               *
 *------------------------- Parameters --------------------------*
-* const int clientSocket: The client to handle.                 *
+* const int sequence: The number of this state for the client.  *
+*                                                               *
+* const bool isFullState: True: The body is the whole state;    *
+*   False: The body is what changed since the last state.       *
+*                                                               *
+* const int playerIndex: The index of the client's seat.        *
+*                                                               *
+* char data[]: Where the header is written. At least            *
+*   STATE_HEADER_CODE_SIZE long.                                *
 *                                                               *
 *------------------------- Return Value ------------------------*
-* Return the action the client requested.                       *
+* Returns the number of bytes written.                          *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-Action ServerConnection::InterpretClientRequest(const int clientSocket)
+int ServerConnection::EncodeStateHeaderCodes(const int sequence, const bool isFullState, const int playerIndex, char data[])
 {
-    char request[CLIENT_ACTION_LENGTH + 1];
-    bool stillConnected = ReadDataFromClient(clientSocket, request, CLIENT_ACTION_LENGTH + 1); //LIST_GAME_TIMEOUT_S
-    request[CLIENT_ACTION_LENGTH] = '\0';
-    if (!stillConnected)
+    int at = 0;
+    data[at++] = isFullState ? FULL_STATE_CODE : CHANGED_STATE_CODE;
+    PutInt32(&data[at], sequence);
+    at += WIRE_INT_SIZE;
+    if (isFullState)
     {
-        return UNREGISTER;
+        data[at++] = (char) playerIndex;
     }
+    return at;
+}
 
-    // list 
-    if (strcmp(request, LIST_GAME_REQUEST) == 0)
-    {
-        return LIST;
-    }
-    // create
-    else if (strcmp(request, CREATE_REQUEST) == 0)
-    {
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         EncodeStateCodes                      *
+*------------------------- Description -------------------------*
+* Format a game state for protocol 2 in one pass: the turn and  *
+* new round flag as a byte each, the money and bets as integers,*
+* then each hand as its card count and a code per card.         *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const StateData &state: The state of the game.                *
+*                                                               *
+* char data[]: Where the state is written. At least             *
+*   STATE_CODE_BUFFER_SIZE long.                                *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of bytes written.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::EncodeStateCodes(const StateData &state, char data[])
+{
+    int at = 0;
+    data[at++] = (char) state.playerTurn;
+    data[at++] = state.isNewRound ? 1 : 0;
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        PutInt32(&data[at], state.playerMoney[i]);
+        at += WIRE_INT_SIZE;
+    }
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        PutInt32(&data[at], state.playerBets[i]);
+        at += WIRE_INT_SIZE;
+    }
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        at += EncodeCards(state.shownCards[i], 0, &data[at]);
+    }
+    return at;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      EncodeStateChangeCodes                   *
+*------------------------- Description -------------------------*
+* Format the changes EncodeStateChanges() finds, for protocol 2.*
+* Each change is its code and seat as a byte each, then an      *
+* integer for money and bets, or a card count and a code per    *
+* card for hands.                                               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const StateData &previous: The state the client already has.  *
+*                                                               *
+* const StateData &state: The state of the game.                *
+*                                                               *
+* char data[]: Where the changes are written. At least          *
+*   STATE_CODE_BUFFER_SIZE long.                                *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of bytes written.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::EncodeStateChangeCodes(const StateData &previous, const StateData &state, char data[])
+{
+    int at = 0;
+    data[at++] = (char) state.playerTurn;
+    data[at++] = state.isNewRound ? 1 : 0;
+    for(int i = 0; i <= PLAYER_COUNT; i++)
+    {
+        if (state.playerMoney[i] != previous.playerMoney[i])
+        {
+            data[at++] = MONEY_CHANGED_CODE;
+            data[at++] = (char) i;
+            PutInt32(&data[at], state.playerMoney[i]);
+            at += WIRE_INT_SIZE;
+        }
+        if (state.playerBets[i] != previous.playerBets[i])
+        {
+            data[at++] = BET_CHANGED_CODE;
+            data[at++] = (char) i;
+            PutInt32(&data[at], state.playerBets[i]);
+            at += WIRE_INT_SIZE;
+        }
+
+        // send only the new cards if the hand grew, otherwise the whole hand
+        const Hand &oldHand = previous.shownCards[i];
+        const Hand &newHand = state.shownCards[i];
+        if (newHand == oldHand)
+        {
+            continue;
+        }
+        int firstCard = 0;
+        if (newHand.Size() > oldHand.Size() && newHand.StartsWith(oldHand))
+        {
+            data[at++] = CARDS_ADDED_CODE;
+            firstCard = oldHand.Size();
+        }
+        else
+        {
+            data[at++] = HAND_REPLACED_CODE;
+        }
+        data[at++] = (char) i;
+        at += EncodeCards(newHand, firstCard, &data[at]);
+    }
+    return at;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          EncodeCards                          *
+*------------------------- Description -------------------------*
+* Write part of a hand for protocol 2: the number of cards, then*
+* a code per card.                                              *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Hand &hand: The hand.                                   *
+*                                                               *
+* const int firstCard: The index of the first card to write.    *
+*                                                               *
+* char data[]: Where the cards are written.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of bytes written.                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::EncodeCards(const Hand &hand, const int firstCard, char data[])
+{
+    // a hand holds at most MAX_HAND_SIZE cards, so the count fits in a byte
+    int at = 0;
+    data[at++] = (char) (hand.Size() - firstCard);
+    for(int j = firstCard; j < hand.Size(); j++)
+    {
+        data[at++] = (char) CardRank(hand.CardAt(j));
+    }
+    return at;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        HandleStateMessage                     *
+*------------------------- Description -------------------------*
+* Apply a state confirmation or resync request from the client. *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Client &client: The client that sent the message.             *
+*                                                               *
+* const char message[]: The message read from the client.       *
+*                                                               *
+* const int length: The number of bytes in message.             *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the message was about the state stream.       *
+* Returns false if the message is some other request.           *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::HandleStateMessage(Client &client, const char message[], const int length)
+{
+    // in protocol 2 every message starts with its code
+    if (client.protocol == PROTOCOL_VERSION)
+    {
+        if (length == 1 + WIRE_INT_SIZE && message[0] == STATE_CONFIRM_CODE)
+        {
+            client.statesConfirmed = std::max(client.statesConfirmed, (int) GetInt32(message + 1));
+            return true;
+        }
+        if (length == 1 && message[0] == STATE_RESYNC_CODE)
+        {
+            client.needsFullState = true;
+            return true;
+        }
+        return false;
+    }
+
+    const size_t confirmLength = strlen(STATE_CONFIRM);
+    if (strncmp(message, STATE_CONFIRM, confirmLength) == 0)
+    {
+        client.statesConfirmed = std::max(client.statesConfirmed, atoi(message + confirmLength));
+        return true;
+    }
+    if (strcmp(message, STATE_RESYNC) == 0)
+    {
+        client.needsFullState = true;
+        return true;
+    }
+    return false;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      ReadRequestFromClient                    *
+*------------------------- Description -------------------------*
+* Read the next request from the client. State confirmations and*
+* resync requests are applied and skipped, and requests held    *
+* back while waiting for a confirmation are returned first.     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* char buffer[]: Where the request will be placed.              *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::ReadRequestFromClient(const int clientSocket, char buffer[], const int bufferSize)
+{
+    int length;
+    return ReadRequestFromClient(clientSocket, buffer, bufferSize, length);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      ReadRequestFromClient                    *
+*------------------------- Description -------------------------*
+* Read the next request from the client, and say how long it is.*
+* If the last protocol 2 request's payload has not been read, it*
+* is returned as if it were sent on its own.                    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* char buffer[]: Where the request will be placed. Null         *
+*   terminated, and cut short if it doesn't fit.                *
+*                                                               *
+* const int bufferSize: The size of buffer.                     *
+*                                                               *
+* int &length: Set to the number of bytes placed in buffer, not *
+*   counting the null.                                          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::ReadRequestFromClient(const int clientSocket, char buffer[], const int bufferSize, int &length)
+{
+    std::shared_ptr<Client> handle = clients.Find(clientSocket);
+    if (handle == nullptr)
+    {
+        return false;
+    }
+    Client &client = *handle;
+    char message[REQUEST_BUFFER_SIZE];
+    const char *request = message;
+    int requestLength;
+    if (client.hasPayload)
+    {
+        request = client.payload.data();
+        requestLength = client.payload.size();
+        client.hasPayload = false;
+    }
+    else if (!client.heldRequests.empty())
+    {
+        // copied out before it is dropped from the queue
+        requestLength = std::min((int) client.heldRequests.front().size(), REQUEST_BUFFER_SIZE - 1);
+        memcpy(message, client.heldRequests.front().data(), requestLength);
+        client.heldRequests.pop_front();
+    }
+    else
+    {
+        do
+        {
+            if (!ReadDataFromClient(clientSocket, message, REQUEST_BUFFER_SIZE, requestLength))
+            {
+                return false;
+            }
+        } while (HandleStateMessage(client, message, requestLength));
+    }
+
+    length = std::min(requestLength, bufferSize - 1);
+    memcpy(buffer, request, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      ReadNumberFromClient                     *
+*------------------------- Description -------------------------*
+* Read a number the client sent after a request: as text in     *
+* protocol 1, or as an integer in protocol 2.                   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* int &value: Set to the number. 0 if none was sent.            *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::ReadNumberFromClient(const int clientSocket, int &value)
+{
+    char buffer[REQUEST_BUFFER_SIZE];
+    int length;
+    if (!ReadRequestFromClient(clientSocket, buffer, REQUEST_BUFFER_SIZE, length))
+    {
+        return false;
+    }
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return false;
+    }
+    if (client->protocol == PROTOCOL_VERSION)
+    {
+        value = (length == WIRE_INT_SIZE) ? GetInt32(buffer) : 0;
+    }
+    else
+    {
+        value = atoi(buffer);
+    }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           SendAnswer                          *
+*------------------------- Description -------------------------*
+* Tell the client if their action was valid, in the protocol    *
+* they speak.                                                   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* const bool isValid: True: The action was valid; False: It was *
+*   not.                                                        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::SendAnswer(const int clientSocket, const bool isValid)
+{
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client != nullptr && client->protocol == PROTOCOL_VERSION)
+    {
+        const char answer = isValid ? SERVER_TRUE_CODE : SERVER_FALSE_CODE;
+        return SendDataToClient(clientSocket, &answer, 1);
+    }
+    return SendDataToClient(clientSocket, isValid ? SERVER_TRUE : SERVER_FALSE);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       HoldWaitingRequests                     *
+*------------------------- Description -------------------------*
+* Take every whole message already read off the client's socket *
+* without waiting for more. State confirmations and resync      *
+* requests are applied, and other requests are held for         *
+* ReadRequestFromClient().                                      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::HoldWaitingRequests(const int clientSocket)
+{
+    std::shared_ptr<Client> handle = clients.Find(clientSocket);
+    if (handle == nullptr)
+    {
+        return;
+    }
+    Client &client = *handle;
+    char message[REQUEST_BUFFER_SIZE];
+    int length = 0;
+    while (HasWaitingData(clientSocket))
+    {
+        ReadDataFromClient(clientSocket, message, REQUEST_BUFFER_SIZE, length);
+        if (!HandleStateMessage(client, message, length))
+        {
+            client.heldRequests.push_back(std::string(message, length));
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        HasPayloadMessage                      *
+*------------------------- Description -------------------------*
+* Check if a protocol 1 request is followed by a message of its *
+* own holding what the request is about, such as a name or an   *
+* amount. In protocol 2 that is part of the request instead.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string &request: The protocol 1 request.           *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the request's handler reads another message.  *
+* Returns false if the request stands on its own.               *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::HasPayloadMessage(const std::string &request)
+{
+    const char* withPayload[] = {PROTOCOL_REQUEST, SEARCH_REQUEST, CREATE_REQUEST, JOIN_REQUEST, JOIN_TABLE_REQUEST, BET_REQUEST};
+    for (const char* action : withPayload)
+    {
+        if (request.compare(0, CLIENT_ACTION_LENGTH, action) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          Constructor                          *
+*------------------------- Description -------------------------*
+* Set up the server. Its UDP socket is opened with              *
+* OpenDiscoverySocket(), and TCP sockets are added with         *
+* OpenGameSocket().                                             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+ServerConnection::ServerConnection()
+{
+    udpConnection = -1;
+    quickJoinSignal = StartSignal();
+
+    // the only time the system is asked for randomness
+    std::random_device device;
+    SeedShoes(((uint64_t) device() << 32) | device(), false);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           SeedShoes                           *
+*------------------------- Description -------------------------*
+* Set the master seed the games made from now on get their      *
+* random streams from. The server seeds itself randomly, so this*
+* is only needed to replay shoes or make a run repeatable.      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const uint64_t seed: The master seed.                         *
+*                                                               *
+* const bool logSeeds: True: Log the seed, and each game's      *
+*   stream as it is made; False: Don't.                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::SeedShoes(const uint64_t seed, const bool logSeeds)
+{
+    std::lock_guard<std::mutex> guard(streamLock);
+    nextStream.Seed(seed);
+    streamCount = 0;
+    isLoggingSeeds = logSeeds;
+    if (isLoggingSeeds)
+    {
+        std::cout << "Shoe seed " << seed << std::endl;
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         SetDealingMode                        *
+*------------------------- Description -------------------------*
+* Set how the games made from now on deal. Games deal from      *
+* shoes unless this is called.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const DealingMode mode: How the games deal.                   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::SetDealingMode(const DealingMode mode)
+{
+    std::lock_guard<std::mutex> guard(streamLock);
+    dealingMode = mode;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          Destructor                           *
+*------------------------- Description -------------------------*
+* Close each client's connection, the UDP socket, and the TCP   *
+* soket                                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+ServerConnection::~ServerConnection()
+{
+    // close client sockets
+    clients.ForEach([](const int socket, Client &)
+    {
+        CloseConnection(socket);
+    });
+
+    //close server sockets
+    CloseConnection(udpConnection);
+    udpConnection = -1;
+    for (int tcpConnection : tcpConnections)
+    {
+        CloseConnection(tcpConnection);
+    }
+    tcpConnections.clear();
+    CloseConnection(quickJoinSignal);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      OpenDiscoverySocket                      *
+*------------------------- Description -------------------------*
+* Open the UDP socket clients find the server on. Call once,    *
+* before any game socket is opened. It fails if another server  *
+* is already running on this computer, as it would otherwise    *
+* share the game port and be handed some of the clients.        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the socket is open. Returns false if it could *
+* not be opened, in which case the server should not start.     *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::OpenDiscoverySocket()
+{
+    return StartServer(udpConnection);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         OpenGameSocket                        *
+*------------------------- Description -------------------------*
+* Open another TCP socket clients can connect to. Every game    *
+* socket shares the game port, and the kernel spreads new       *
+* clients across them.                                          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int backlog: The most clients that may wait to be       *
+*   accepted on this socket.                                    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Return an int representing the game socket. Returns -1 if it  *
+* could not be opened.                                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::OpenGameSocket(const int backlog)
+{
+    int gameSocket = StartGameSocket(backlog);
+    if (gameSocket >= 0)
+    {
+        std::lock_guard<std::mutex> guard(tcpConnectionsLock);
+        tcpConnections.push_back(gameSocket);
+    }
+    return gameSocket;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        AcceptNewClients                       *
+*------------------------- Description -------------------------*
+* Accept and register every client waiting on a game socket.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int gameSocket: A socket from OpenGameSocket().         *
+*                                                               *
+* int newSockets[]: Where the new client connections are put.   *
+*                                                               *
+* const int maxClients: The most clients to accept.             *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Return the number of clients accepted.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::AcceptNewClients(const int gameSocket, int newSockets[], const int maxClients)
+{
+    int count = AcceptClients(gameSocket, newSockets, maxClients);
+    for (int i = 0; i < count; i++)
+    {
+        std::shared_ptr<Client> newClient = std::make_shared<Client>();
+        newClient->socket = newSockets[i];
+        clients.Insert(newSockets[i], std::move(newClient));
+    }
+    return count;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        AnswerDiscovery                        *
+*------------------------- Description -------------------------*
+* Answer clients looking for the server over UDP. Never returns,*
+* so run it on its own thread.                                  *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::AnswerDiscovery()
+{
+    AnswerDiscoveryProbes(udpConnection);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                     InterpretClientRequest                    *
+*------------------------- Description -------------------------*
+* Given a client connection, wait until they send an action     *
+* code. Interpret the code and return what action was requested.*
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Return the action the client requested.                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+Action ServerConnection::InterpretClientRequest(const int clientSocket)
+{
+    // a payload the last request's handler never read is dropped
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return UNREGISTER;
+    }
+    client->hasPayload = false;
+
+    char request[REQUEST_BUFFER_SIZE];
+    int length;
+    bool stillConnected = ReadRequestFromClient(clientSocket, request, REQUEST_BUFFER_SIZE, length); //LIST_GAME_TIMEOUT_S
+    if (!stillConnected)
+    {
+        return UNREGISTER;
+    }
+
+    // protocol 2 requests are one byte, then the payload the request's handler reads
+    if (client->protocol == PROTOCOL_VERSION)
+    {
+        if (length == 0)
+        {
+            return NONE;
+        }
+        // only the requests whose handler reads a payload hold one, so nothing
+        // is left unread after a request that stands on its own
+        client->payload.assign(request + 1, length - 1);
+        switch ((uint8_t) request[0])
+        {
+            case LIST_GAME_CODE:
+                return LIST;
+            case SUBSCRIBE_CODE:
+                return SUBSCRIBE;
+            case SEARCH_CODE:
+                client->hasPayload = true;
+                return SEARCH;
+            case CREATE_CODE:
+                client->hasPayload = true;
+                return CREATE;
+            case JOIN_CODE:
+                client->hasPayload = true;
+                return JOIN;
+            case JOIN_TABLE_CODE:
+                client->hasPayload = true;
+                return JOINTABLE;
+            case QUICK_JOIN_CODE:
+                return QUICKJOIN;
+            case EXIT_CODE:
+                return EXIT;
+            case UNREGISTER_CODE:
+                return UNREGISTER;
+            case BET_CODE:
+                client->hasPayload = true;
+                return BET;
+            case HIT_CODE:
+                return HIT;
+            case STAND_CODE:
+                return STAND;
+            default:
+                return NONE;
+        }
+    }
+
+    // protocol 1 requests are a word of CLIENT_ACTION_LENGTH letters
+    request[CLIENT_ACTION_LENGTH] = '\0';
+    // protocol
+    if (strcmp(request, PROTOCOL_REQUEST) == 0)
+    {
+        return PROTOCOL;
+    }
+    // list 
+    else if (strcmp(request, LIST_GAME_REQUEST) == 0)
+    {
+        return LIST;
+    }
+    // subscribe
+    else if (strcmp(request, SUBSCRIBE_REQUEST) == 0)
+    {
+        return SUBSCRIBE;
+    }
+    // search
+    else if (strcmp(request, SEARCH_REQUEST) == 0)
+    {
+        return SEARCH;
+    }
+    // create
+    else if (strcmp(request, CREATE_REQUEST) == 0)
+    {
         return CREATE;
     }
     // join
@@ -190,59 +1234,464 @@ Action ServerConnection::InterpretClientRequest(const int clientSocket)
     {
         return JOIN;
     }
+    // join by table id
+    else if (strcmp(request, JOIN_TABLE_REQUEST) == 0)
+    {
+        return JOINTABLE;
+    }
+    // quick join
+    else if (strcmp(request, QUICK_JOIN_REQUEST) == 0)
+    {
+        return QUICKJOIN;
+    }
     //exit
     else if (strcmp(request, EXIT_REQUEST) == 0)
     {
-        return EXIT;
+        return EXIT;
+    }
+    //unregister
+    else if (strcmp(request, UNREGISTER_REQUEST) == 0)
+    {
+        return UNREGISTER;
+    }
+    //bet
+    else if (strcmp(request, BET_REQUEST) == 0)
+    {
+        return BET;
+    }
+    //hit
+    else if (strcmp(request, HIT_REQUEST) == 0)
+    {
+        return HIT;
+    }
+    //stand
+    else if (strcmp(request, STAND_REQUEST) == 0)
+    {
+        return STAND;
+    }
+    return NONE;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       NegotiateProtocol                       *
+*------------------------- Description -------------------------*
+* Recive the newest protocol version the client speaks, answer  *
+* with the version both sides speak, and use it for the rest of *
+* the connection.                                               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::NegotiateProtocol(const int clientSocket)
+{
+    // read the client's newest version
+    char buffer[REQUEST_BUFFER_SIZE];
+    if (!ReadRequestFromClient(clientSocket, buffer, REQUEST_BUFFER_SIZE))
+    {
+        return false;
+    }
+    int version = std::max(1, std::min(atoi(buffer), PROTOCOL_VERSION));
+
+    // answer in the protocol the client asked in, then switch, as the
+    // client sends nothing more until it has the answer
+    std::string answer = std::to_string(version);
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return false;
+    }
+    bool hasSucceeded = SendDataToClient(clientSocket, answer.c_str());
+    client->protocol = version;
+    return hasSucceeded;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        HasClientRequest                       *
+*------------------------- Description -------------------------*
+* Check, without waiting, if the client has a whole request     *
+* ready for InterpretClientRequest() and the request's handler. *
+* Only messages already read off the socket are looked at. A    *
+* protocol 1 request with a payload needs both its messages.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the next request can be read without waiting. *
+*   Also true if the client is gone, so callers stop waiting.   *
+* Returns false if more has to be read from the client first.   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::HasClientRequest(const int clientSocket)
+{
+    // a client that is gone has nothing more to wait for
+    HoldWaitingRequests(clientSocket);
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return true;
+    }
+    if (client->heldRequests.empty())
+    {
+        return false;
+    }
+    return client->protocol == PROTOCOL_VERSION || !HasPayloadMessage(client->heldRequests.front())
+        || client->heldRequests.size() > 1;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         HasStateWindow                        *
+*------------------------- Description -------------------------*
+* Check, without waiting, if the client can be sent another     *
+* state without falling STATE_WINDOW states behind. Only        *
+* confirmations already read off the socket are counted.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if a state can be sent without waiting.          *
+*   Also true if the client is gone, so callers stop waiting.   *
+* Returns false if more has to be read from the client first.   *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::HasStateWindow(const int clientSocket)
+{
+    // a client that is gone has nothing more to wait for
+    HoldWaitingRequests(clientSocket);
+    std::shared_ptr<Client> handle = clients.Find(clientSocket);
+    if (handle == nullptr)
+    {
+        return true;
+    }
+    Client &client = *handle;
+    return client.statesSent - client.statesConfirmed < STATE_WINDOW;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           ListGames                           *
+*------------------------- Description -------------------------*
+* Send the client a list of the first LOBBY_PAGE_SIZE games     *
+* available to join, in name order. The rest can be found with  *
+* SearchGames(). The list is built ahead of time, so sending it *
+* is one write.                                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::ListGames(const int clientSocket)
+{
+    // send client the list of games, holding onto it in case a new one is published meanwhile
+    std::shared_ptr<const LobbySnapshot> snapshot = GetLobbySnapshot();
+    bool hasSucceeded = true;
+    hasSucceeded = SendDataToClient(clientSocket, snapshot->list.data(), snapshot->list.size());
+    if (hasSucceeded)
+    {
+        return true;
+    }
+    return false;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          UpdateLobby                          *
+*------------------------- Description -------------------------*
+* Record the game's change in the lobby index, mark the list of *
+* open games out of date, and queue the change for lobby        *
+* subscribers. Call after a game opens, closes, or has a seat   *
+* taken or freed, holding the game's seat lock if it is open,   *
+* and before a closed game is removed. The list is rebuilt the  *
+* next time it is asked for, so a burst of changes costs one    *
+* rebuild. A tick with more changes than one push can hold is   *
+* queued as a single sign that the lobby changed.               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const Game &game: The game that changed.                      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::UpdateLobby(const Game &game)
+{
+    // the index changes and the version counts up together, so a list built at a version
+    // has exactly the changes up to it, and subscribers can skip those when they are pushed.
+    // Each change says the game's whole lobby entry, so sending it twice does no harm
+    std::string event;
+    {
+        std::lock_guard<std::mutex> guard(lobbyIndexLock);
+        if (game.isOpen)
+        {
+            int taken = SeatsTakenInRoom(game);
+            lobbyIndex[game.name] = {game.id, taken};
+            event = GAME_LISTED + std::to_string(++lobbyVersion) + ' ' + std::to_string(taken) + ' ' + game.name + '\n';
+        }
+        else
+        {
+            lobbyIndex.erase(game.name);
+            event = GAME_UNLISTED + std::to_string(++lobbyVersion) + ' ' + game.name + '\n';
+        }
+    }
+
+    // queue it on every lobby thread with subscribers, starting the tick if it was idle
+    std::lock_guard<std::mutex> guard(lobbyFeedsLock);
+    for (const std::unique_ptr<LobbyFeed> &feed : lobbyFeeds)
+    {
+        if (feed->subscriberCount == 0)
+        {
+            continue;
+        }
+        std::lock_guard<std::mutex> pendingGuard(feed->lock);
+        if (feed->pending.empty())
+        {
+            SetTimer(feed->ticker, LOBBY_TICK_MS);
+        }
+
+        // clients only use a push as a sign to search again, so a tick too big to push
+        // is cut down to one line saying the lobby changed, which also bounds pending
+        if (feed->isCollapsed || strlen(LOBBY_EVENTS) + feed->pending.size() + event.size() > MAX_LOBBY_PUSH_SIZE)
+        {
+            feed->pending = LOBBY_CHANGED + std::to_string(lobbyVersion) + '\n';
+            feed->isCollapsed = true;
+        }
+        else
+        {
+            feed->pending += event;
+        }
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         OpenLobbyFeed                         *
+*------------------------- Description -------------------------*
+* Set up the lobby changes pushed to one lobby thread's         *
+* subscribers. The feed's ticker must be watched by that thread,*
+* which calls SendLobbyEvents() each time it goes off.          *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the feed, which lasts as long as the server. Returns  *
+* nullptr if its ticker could not be made.                      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+LobbyFeed* ServerConnection::OpenLobbyFeed()
+{
+    std::unique_ptr<LobbyFeed> feed = std::make_unique<LobbyFeed>();
+    feed->ticker = StartTimer();
+    if (feed->ticker < 0)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(lobbyFeedsLock);
+    lobbyFeeds.push_back(std::move(feed));
+    return lobbyFeeds.back().get();
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SubscribeToLobby                       *
+*------------------------- Description -------------------------*
+* Send the client every open game and its seats taken, then push*
+* them each change from then on until they leave the lobby.     *
+* Call from the lobby thread the feed belongs to.               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* LobbyFeed *feed: The feed of the client's lobby thread.       *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::SubscribeToLobby(const int clientSocket, LobbyFeed *feed)
+{
+    // start queueing changes before the list is built, so none made after it are missed.
+    // A client already subscribed just gets the list again
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return false;
+    }
+    if (!client->isSubscribed)
+    {
+        client->isSubscribed = true;
+        feed->subscriberCount++;
+        feed->subscribers.push_back(clientSocket);
+    }
+    std::shared_ptr<const LobbySnapshot> snapshot = GetLobbySnapshot();
+    return SendDataToClient(clientSocket, snapshot->subscription.data(), snapshot->subscription.size());
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          SearchGames                          *
+*------------------------- Description -------------------------*
+* Recive a search from the client and send them one page of the *
+* open games that match it. The search is whether only games    *
+* with a free seat are wanted, then the prefix the names must   *
+* start with and the name to start after, split by '\n'. The    *
+* page is the name to start the next page after (empty on the   *
+* last page), then each game's seats taken, table id and name,  *
+* one per line.                                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::SearchGames(const int clientSocket)
+{
+    // read search from client
+    char buffer[REQUEST_BUFFER_SIZE];
+    if (!ReadRequestFromClient(clientSocket, buffer, REQUEST_BUFFER_SIZE))
+    {
+        return false;
+    }
+    bool freeSeatsOnly = (buffer[0] == FREE_SEATS_ONLY);
+    std::string search = (buffer[0] == '\0') ? "" : buffer + 1;
+    size_t split = search.find('\n');
+    std::string prefix = search.substr(0, split);
+    std::string after = (split == std::string::npos) ? "" : search.substr(split + 1);
+
+    // send client the page, which never holds more than LOBBY_PAGE_SIZE games
+    std::string page;
+    {
+        std::lock_guard<std::mutex> guard(lobbyIndexLock);
+        std::string games;
+        page = GetPageOfGames(prefix, freeSeatsOnly, after, games);
+        page += '\n';
+        page += games;
+    }
+    return SendDataToClient(clientSocket, page.data(), page.size());
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      UnsubscribeFromLobby                     *
+*------------------------- Description -------------------------*
+* Stop pushing lobby changes to the client. Does nothing if they*
+* are not subscribed. Call from the lobby thread the feed       *
+* belongs to before the client leaves it.                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* LobbyFeed *feed: The feed of the client's lobby thread.       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::UnsubscribeFromLobby(const int clientSocket, LobbyFeed *feed)
+{
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr || !client->isSubscribed)
+    {
+        return;
     }
-    //unregister
-    else if (strcmp(request, UNREGISTER_REQUEST) == 0)
+    client->isSubscribed = false;
+    feed->subscribers.erase(std::find(feed->subscribers.begin(), feed->subscribers.end(), clientSocket));
+    feed->subscriberCount--;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SendLobbyEvents                        *
+*------------------------- Description -------------------------*
+* Push the lobby changes gathered since the last send to every  *
+* subscriber of the feed as one message, encoded once. A        *
+* message too big for clients to read is cut down to a sign     *
+* that the lobby changed. Clients that can't be sent to are     *
+* unsubscribed. Call from the lobby thread the feed belongs to  *
+* when its ticker goes off.                                     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* LobbyFeed *feed: The feed to send.                            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::SendLobbyEvents(LobbyFeed *feed)
+{
+    // take everything gathered so far. Changes made from here on start the next tick
+    std::string events = LOBBY_EVENTS;
     {
-        return UNREGISTER;
+        std::lock_guard<std::mutex> guard(feed->lock);
+        if (feed->pending.empty())
+        {
+            return;
+        }
+        events += feed->pending;
+        feed->pending.clear();
+        feed->isCollapsed = false;
     }
-    //bet
-    else if (strcmp(request, BET_REQUEST) == 0)
+    if (feed->subscribers.empty())
     {
-        return BET;
+        return;
     }
-    //hit
-    else if (strcmp(request, HIT_REQUEST) == 0)
+
+    // clients drop any message bigger than they can read, so never send one
+    if (events.size() > MAX_LOBBY_PUSH_SIZE)
     {
-        return HIT;
+        events = LOBBY_EVENTS + (LOBBY_CHANGED + std::to_string(lobbyVersion) + '\n');
     }
-    //stand
-    else if (strcmp(request, STAND_REQUEST) == 0)
+
+    // every subscriber is sent the same message
+    int count = feed->subscribers.size();
+    std::vector<const char*> data(count, events.c_str());
+    std::unique_ptr<bool[]> stillConnected(new bool[count]);
+    std::vector<int> sockets = feed->subscribers;
+    SendDataToClients(sockets.data(), data.data(), count, stillConnected.get());
+
+    // the lobby thread finds out the client is gone the next time it reads from them
+    for (int i = 0; i < count; i++)
     {
-        return STAND;
+        if (!stillConnected[i])
+        {
+            UnsubscribeFromLobby(sockets[i], feed);
+        }
     }
-    return NONE;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-*                           ListGames                           *
+*                        GetLobbySnapshot                       *
 *------------------------- Description -------------------------*
-* Send the client a list of all the games available to join.    *
-*                                                               *
-*------------------------- Parameters --------------------------*
-* const int clientSocket: The client to handle.                 *
+* Get the current list of open games, publishing a new one first*
+* if the games have changed since the last was built.           *
 *                                                               *
 *------------------------- Return Value ------------------------*
-* Returns true if the connection to the client is still active. *
-* Returns false if the connection to the client has terminated. *
+* Returns the list. It never changes, and stays valid for as    *
+* long as it is held, even once a newer list replaces it.       *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-bool ServerConnection::ListGames(const int clientSocket)
+std::shared_ptr<const LobbySnapshot> ServerConnection::GetLobbySnapshot()
 {
-    std::string data;
-    GetListOfGames(data);
-    // send client the list of games
-    bool hasSucceeded = true;
-    hasSucceeded = SendDataToClient(clientSocket, data.c_str());
-    if (hasSucceeded)
+    // most of the time nothing has changed and the list is just handed out
+    std::shared_ptr<const LobbySnapshot> snapshot = lobbySnapshot.load();
+    if (snapshot != nullptr && snapshot->version == lobbyVersion)
     {
-        return true;
+        return snapshot;
     }
-    return false;
+
+    // rebuild one at a time, checking again in case another thread just did
+    std::lock_guard<std::mutex> guard(lobbyPublishLock);
+    snapshot = lobbySnapshot.load();
+    if (snapshot != nullptr && snapshot->version == lobbyVersion)
+    {
+        return snapshot;
+    }
+    // the version can't count up while the index is read, so the list matches it exactly
+    std::shared_ptr<LobbySnapshot> rebuilt = std::make_shared<LobbySnapshot>();
+    {
+        std::lock_guard<std::mutex> indexGuard(lobbyIndexLock);
+        rebuilt->version = lobbyVersion;
+        rebuilt->subscription = LOBBY_SNAPSHOT + std::to_string(rebuilt->version) + '\n';
+        GetListOfGames(rebuilt->list, rebuilt->subscription);
+    }
+    snapshot = rebuilt;
+    lobbySnapshot.store(snapshot);
+    return snapshot;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -264,35 +1713,41 @@ bool ServerConnection::CreateGame(const int clientSocket)
     // read name from client
     char buffer[1024];
     bool hasSucceeded = true;
-    hasSucceeded = ReadDataFromClient(clientSocket, buffer, ROOM_NAME_BUFFER_SIZE);
+    hasSucceeded = ReadRequestFromClient(clientSocket, buffer, ROOM_NAME_BUFFER_SIZE);
     if (!hasSucceeded)
     {
         return false;
     }
 
-    //check if room already exists
-    bool validRoom = !DoesGameExist(buffer);
-    // make the room and let the client know
+    // make the room unless the name is taken, so two clients can't make the same room
+    std::shared_ptr<Game> newGame = std::make_shared<Game>();
+    newGame->name = buffer;
+    bool validRoom = AddGame(newGame);
+
+    // let the client know, dropping the room if they are gone
     if(validRoom)
     {
-        hasSucceeded = SendDataToClient(clientSocket, SERVER_TRUE);
+        {
+            std::lock_guard<std::mutex> guard(newGame->seatEvents.lock);
+            UpdateLobby(*newGame);
+        }
+        hasSucceeded = SendAnswer(clientSocket, true);
         if (hasSucceeded)
         {
-            Game newGame;
-            for(int i =0; i < PLAYER_COUNT; i++)
-            {
-                newGame.players[i] = nullptr;
-            }
-            newGame.name = buffer;
-            games[buffer] = newGame;
             return true;
         }
+        {
+            std::lock_guard<std::mutex> guard(newGame->seatEvents.lock);
+            newGame->isOpen = false;
+            UpdateLobby(*newGame);
+        }
+        RemoveGame(*newGame);
         return false;
     }
     // let the client know the room is not valid
     else
     {
-        SendDataToClient(clientSocket, SERVER_FALSE);
+        SendAnswer(clientSocket, false);
         if (hasSucceeded)
         {
             return true;
@@ -310,55 +1765,194 @@ bool ServerConnection::CreateGame(const int clientSocket)
 *------------------------- Parameters --------------------------*
 * const int clientSocket: The client to handle.                 *
 *                                                               *
+* bool &isSeated: Set to true if the client was given a seat,   *
+*   and has left the lobby.                                     *
+*                                                               *
 *------------------------- Return Value ------------------------*
 * Returns true if the connection to the client is still active. *
 * Returns false if the connection to the client has terminated. *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-bool ServerConnection::JoinGame(const int clientSocket)
+bool ServerConnection::JoinGame(const int clientSocket, bool &isSeated)
 {
     // read name from client
     char buffer[1024];
     bool hasSucceeded = true;
-    hasSucceeded = ReadDataFromClient(clientSocket, buffer, ROOM_NAME_BUFFER_SIZE);
+    hasSucceeded = ReadRequestFromClient(clientSocket, buffer, ROOM_NAME_BUFFER_SIZE);
     if (!hasSucceeded)
     {
         return false;
     }
 
-    // check if room exists
-    bool validRoom = DoesGameExist(buffer);
+    // the name is only needed to find the room's table id
+    std::shared_ptr<int> tableId = tableIds.Find(buffer);
+    std::shared_ptr<Game> game = (tableId != nullptr) ? games.Find(*tableId) : nullptr;
+    return JoinRoom(clientSocket, game, isSeated);
+}
 
-    // check if the room has full players
-    int nextSeat;
-    if (validRoom)
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           JoinTable                           *
+*------------------------- Description -------------------------*
+* Recive a table id from the client, as listed by SearchGames(),*
+* and add them to the game if able.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* bool &isSeated: Set to true if the client was given a seat,   *
+*   and has left the lobby.                                     *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::JoinTable(const int clientSocket, bool &isSeated)
+{
+    // read table id from client
+    int tableId;
+    if (!ReadNumberFromClient(clientSocket, tableId))
     {
-        nextSeat = NextOpenSeatInRoom(buffer);
-        validRoom = (nextSeat != -1);
+        return false;
     }
-    
-    // add the client to the room and let the client know
-    if(validRoom)
+    return JoinRoom(clientSocket, games.Find(tableId), isSeated);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           QuickJoin                           *
+*------------------------- Description -------------------------*
+* Add the client to the matchmaking queue. They are answered    *
+* once SeatQuickJoiner() gives them a seat, or right away if the*
+* queue is full, in which case they stay in the lobby.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* bool &isQueued: Set to true if the client is now waiting on   *
+*   matchmaking, and has left the lobby.                        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the connection to the client is still active. *
+* Returns false if the connection to the client has terminated. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::QuickJoin(const int clientSocket, bool &isQueued)
+{
+    isQueued = quickJoins.Push(clientSocket);
+    if (isQueued)
     {
-        hasSucceeded = SendDataToClient(clientSocket, SERVER_TRUE);
-        if (hasSucceeded)
-        {
-            clients[clientSocket].curGame = &(games[buffer]);
-            games[buffer].players[nextSeat] = &(clients[clientSocket]);
-            return true;
-        }
-        return false;
+        RaiseSignal(quickJoinSignal);
+        return true;
     }
-    // let the client know the room is not valid
-    else
+
+    // let the client know there is no room to wait
+    return SendAnswer(clientSocket, false);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        WaitForQuickJoins                      *
+*------------------------- Description -------------------------*
+* Sleep until clients are waiting on matchmaking, then take as  *
+* many of them as fit, oldest first. Call from one matchmaking  *
+* thread.                                                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* int clientSockets[]: Where the waiting clients are placed.    *
+*                                                               *
+* const int maxClients: The most clients to take at once.       *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the number of clients taken. Always at least one.     *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+int ServerConnection::WaitForQuickJoins(int clientSockets[], const int maxClients)
+{
+    int count = 0;
+    while (true)
     {
-        SendDataToClient(clientSocket, SERVER_FALSE);
-        if(hasSucceeded)
+        while (count < maxClients && quickJoins.Pop(clientSockets[count]))
         {
-            return true;
+            count++;
+        }
+        if (count > 0)
+        {
+            return count;
         }
+
+        // only sleep once the queue is empty, as a client added after
+        // the last check has already raised the signal
+        WaitForSignal(quickJoinSignal);
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         OpenQuickTable                        *
+*------------------------- Description -------------------------*
+* Make an open game for matchmaking to seat clients at, named   *
+* QUICK_TABLE_NAME and a number. The game is warm: its table can*
+* be started before anyone sits, and it waits for its first     *
+* player instead of closing.                                    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the new game.                                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+std::shared_ptr<Game> ServerConnection::OpenQuickTable()
+{
+    std::shared_ptr<Game> newGame = std::make_shared<Game>();
+    newGame->isWarm = true;
+
+    // number the table, skipping any name a client has already taken
+    do
+    {
+        newGame->name = QUICK_TABLE_NAME + std::to_string(++quickTableCount);
+    } while (!AddGame(newGame));
+
+    std::lock_guard<std::mutex> guard(newGame->seatEvents.lock);
+    UpdateLobby(*newGame);
+    return newGame;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        SeatQuickJoiner                        *
+*------------------------- Description -------------------------*
+* Give a client taken from the matchmaking queue a seat at the  *
+* game, tell them, and wake the table. If the client is gone,   *
+* they are removed from the server.                             *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+* const std::shared_ptr<Game> &game: The game to seat them at.  *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the client no longer needs a seat.            *
+* Returns false if the game had no open seat for them.          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ServerConnection::SeatQuickJoiner(const int clientSocket, const std::shared_ptr<Game> &game)
+{
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return true;
+    }
+    if (!SeatClient(client, game))
+    {
         return false;
     }
+
+    // let the client know, then wake the table. If the client is gone,
+    // Unregister() frees the seat and wakes the table itself
+    if (!SendAnswer(clientSocket, true))
+    {
+        Unregister(clientSocket);
+        return true;
+    }
+    std::lock_guard<std::mutex> guard(game->seatEvents.lock);
+    client->isSeatAnswered = true;
+    WakeTable(game->seatEvents.waitingTable);
+    return true;
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -373,19 +1967,27 @@ bool ServerConnection::JoinGame(const int clientSocket)
 void ServerConnection::ExitGame(const int clientSocket)
 {
     // remove from game
-    std::string roomName = clients[clientSocket].curGame->name;
-    clients[clientSocket].curGame = nullptr;
-    for (int i = 0; i < PLAYER_COUNT; i++)
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    std::shared_ptr<Game> game = client->curGame;
+    client->curGame = nullptr;
     {
-        if (games[roomName].players[i] != nullptr)
+        std::lock_guard<std::mutex> guard(game->seatEvents.lock);
+        for (int i = 0; i < PLAYER_COUNT; i++)
         {
-            if (games[roomName].players[i]->socket == clientSocket)
+            if (game->players[i] != nullptr)
             {
-                clients[clientSocket].curGame = nullptr;
-                games[roomName].players[i] = nullptr;
+                if (game->players[i]->socket == clientSocket)
+                {
+                    game->players[i] = nullptr;
+                }
             }
+            
+        }
+        if (game->isOpen)
+        {
+            UpdateLobby(*game);
         }
-        
+        WakeTable(game->seatEvents.waitingTable);
     }
 
     // remove from server
@@ -403,8 +2005,15 @@ void ServerConnection::ExitGame(const int clientSocket)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 void ServerConnection::Unregister(const int clientSocket)
 {
+    // nothing to do if the client is already gone
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return;
+    }
+
     // handle player if they are still in game
-    if(clients[clientSocket].curGame != nullptr)
+    if(client->curGame != nullptr)
     {
         ExitGame(clientSocket);
     }
@@ -412,7 +2021,7 @@ void ServerConnection::Unregister(const int clientSocket)
     else
     {
         // remove client from list of players
-        clients.erase(clientSocket);
+        clients.Erase(clientSocket);
 
         // close client connection
         CloseConnection(clientSocket);
@@ -436,19 +2045,22 @@ void ServerConnection::Unregister(const int clientSocket)
 bool ServerConnection::Bet(const int clientSocket, int& money)
 {
     // read money from client
-    char buffer[1024];
     bool hasSucceeded = true;
-    hasSucceeded = ReadDataFromClient(clientSocket, buffer, BET_BUFFER_SIZE);
+    hasSucceeded = ReadNumberFromClient(clientSocket, money);
     if (!hasSucceeded)
     {
         return false;
     }
-    money = atoi(buffer);
 
     // If player bet too much, reset to all their money
-    if (money > clients[clientSocket].money)
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return false;
+    }
+    if (money > client->money)
     {
-        money = clients[clientSocket].money;
+        money = client->money;
     }
     return true;
 }
@@ -456,7 +2068,12 @@ bool ServerConnection::Bet(const int clientSocket, int& money)
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
 *                         SendStateData                         *
 *------------------------- Description -------------------------*
-* Send the current state of the game to a player.               *
+* Send the current state of the game to a player. Each state is *
+* numbered, and the client confirms them in groups. This never  *
+* waits: a client STATE_WINDOW states behind is skipped, so     *
+* wait for its window first. Only what changed since the last   *
+* state is sent, unless the client just joined or asked to      *
+* resync.                                                       *
 *                                                               *
 *------------------------- Parameters --------------------------*
 * const int clientSocket: The client to handle.                 *
@@ -470,61 +2087,133 @@ bool ServerConnection::Bet(const int clientSocket, int& money)
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 bool ServerConnection::SendStateData(const int clientSocket, const StateData &state)
 {
-    char endOfItem = '_';
-    std::string data = "";
+    bool stillConnected;
+    SendStateDataToPlayers(&clientSocket, &state.playerIndex, state, 1, &stillConnected);
+    return stillConnected;
+}
 
-    // send playerIndex
-    data += std::to_string(state.playerIndex);
-    data += endOfItem;
-    
-    //send playerTurn
-    data += std::to_string(state.playerTurn);
-    data += endOfItem;
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                     SendStateDataToPlayers                    *
+*------------------------- Description -------------------------*
+* Send one game state to several players in one batch. The body *
+* is encoded once per kind of frame and shared by every player, *
+* and only a small header is made per player. Never waits on a  *
+* confirmation: a player STATE_WINDOW states behind is skipped, *
+* so callers wait for every window first.                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSockets[]: The clients to send to.            *
+*                                                               *
+* const int playerIndexes[]: The seat of each client.           *
+*                                                               *
+* const StateData &state: The state of the game. Its            *
+*   playerIndex is ignored.                                     *
+*                                                               *
+* const int count: The number of clients.                       *
+*                                                               *
+* bool stillConnected[]: Set to true for each client whose      *
+*   connection is still active, false otherwise.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ServerConnection::SendStateDataToPlayers(const int clientSockets[], const int playerIndexes[], const StateData &state, const int count, bool stillConnected[])
+{
+    std::shared_ptr<const StateData> sharedState = std::make_shared<const StateData>(state);
 
-    //send newRound
-    if(state.isNewRound)
-    {
-        data += "1";
-        data += endOfItem;
-    }
-    else
-    {
-        data += "0";
-        data += endOfItem;
-    }
+    // the bodies encoded so far, each for the state clients last had (nullptr for the whole
+    // state) in the protocol they speak
+    std::vector<std::string> bodies;
+    std::vector<const StateData*> bodyBases;
+    std::vector<int> bodyProtocols;
 
-    //send player money
-    for(int i = 0; i <= PLAYER_COUNT; i++)
+    // only players with room in their window are sent to
+    std::vector<int> sendSockets;
+    std::vector<int> sendIndexes;
+    std::vector<std::string> heads;
+    std::vector<int> sendBodies;
+    for (int i = 0; i < count; i++)
     {
-        data += std::to_string(state.playerMoney[i]);
-        data += endOfItem;
-    }
+        // the table waits for every window before sending, so one still shut is skipped
+        stillConnected[i] = true;
+        if (!HasStateWindow(clientSockets[i]))
+        {
+            continue;
+        }
 
-    //send player bets
-    for(int i = 0; i <= PLAYER_COUNT; i++)
-    {
-        data += std::to_string(state.playerBets[i]);
-        data += endOfItem;
-    }
+        std::shared_ptr<Client> handle = clients.Find(clientSockets[i]);
+        if (handle == nullptr)
+        {
+            stillConnected[i] = false;
+            continue;
+        }
+        Client &client = *handle;
+        client.statesSent++;
+        bool isFullState = client.needsFullState || client.lastStateSent == nullptr;
+        bool isCoded = client.protocol == PROTOCOL_VERSION;
 
-    //send player hands
-    for(int i = 0; i <= PLAYER_COUNT; i++)
-    {
-        //send number of cards
-        data += std::to_string(state.shownCards[i].size());
-        data += endOfItem;
-        // send each card
-        for(int j = 0; j < state.shownCards[i].size(); j++)
+        // clients sent the same broadcast share a base, so this is usually found
+        const StateData* base = isFullState ? nullptr : client.lastStateSent.get();
+        int body = 0;
+        while (body < (int) bodies.size() && (bodyBases[body] != base || bodyProtocols[body] != client.protocol))
         {
-            data += state.shownCards[i].at(j);
-            data += endOfItem;
+            body++;
+        }
+        if (body == (int) bodies.size())
+        {
+            bodies.emplace_back();
+            bodyBases.push_back(base);
+            bodyProtocols.push_back(client.protocol);
+            std::string &data = bodies.back();
+            if (isCoded)
+            {
+                data.resize(STATE_CODE_BUFFER_SIZE);
+                data.resize(isFullState ? EncodeStateCodes(state, data.data()) : EncodeStateChangeCodes(*base, state, data.data()));
+            }
+            else if (isFullState)
+            {
+                EncodeStateData(state, data);
+            }
+            else
+            {
+                EncodeStateChanges(*base, state, data);
+            }
+        }
+        heads.emplace_back();
+        if (isCoded)
+        {
+            char head[STATE_HEADER_CODE_SIZE];
+            heads.back().assign(head, EncodeStateHeaderCodes(client.statesSent, isFullState, playerIndexes[i], head));
         }
+        else
+        {
+            EncodeStateHeader(client.statesSent, isFullState, playerIndexes[i], heads.back());
+        }
+        client.needsFullState = false;
+        client.lastStateSent = sharedState;
+
+        sendSockets.push_back(clientSockets[i]);
+        sendIndexes.push_back(i);
+        sendBodies.push_back(body);
     }
 
-    SendDataToClient(clientSocket, data.c_str());
-    char response[sizeof(SERVER_TRUE) + 1];
-    ReadDataFromClient(clientSocket, response, sizeof(SERVER_TRUE) + 1);
-    return true;
+    // send every player their header and the shared body in one batch
+    int sendCount = sendSockets.size();
+    std::vector<const char*> headPointers(sendCount);
+    std::vector<size_t> headLengths(sendCount);
+    std::vector<const char*> bodyPointers(sendCount);
+    std::vector<size_t> bodyLengths(sendCount);
+    for (int i = 0; i < sendCount; i++)
+    {
+        headPointers[i] = heads[i].data();
+        headLengths[i] = heads[i].size();
+        bodyPointers[i] = bodies[sendBodies[i]].data();
+        bodyLengths[i] = bodies[sendBodies[i]].size();
+    }
+    std::unique_ptr<bool[]> sent(new bool[sendCount]);
+    SendDataToClients(sendSockets.data(), headPointers.data(), headLengths.data(), bodyPointers.data(), bodyLengths.data(), sendCount, sent.get());
+    for (int i = 0; i < sendCount; i++)
+    {
+        stillConnected[sendIndexes[i]] = sent[i];
+    }
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -536,12 +2225,38 @@ bool ServerConnection::SendStateData(const int clientSocket, const StateData &st
 * const int clientSocket: The client to handle.                 *
 *                                                               *
 *------------------------- Return Value ------------------------*
-* Returns a pointer to the game a user is apart of.             *
+* Returns a handle to the game a user is apart of, which keeps  *
+* the game alive while held. Returns nullptr if the user is not *
+* in a game or is not registered.                               *
 *                                                               *
 *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-Game* ServerConnection::GetUserGame(const int clientSocket)
+std::shared_ptr<Game> ServerConnection::GetUserGame(const int clientSocket)
 {
-    return clients[clientSocket].curGame;
+    std::shared_ptr<Client> client = clients.Find(clientSocket);
+    if (client == nullptr)
+    {
+        return nullptr;
+    }
+    return client->curGame;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           GetClient                           *
+*------------------------- Description -------------------------*
+* Find the state of a given user.                               *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int clientSocket: The client to handle.                 *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns a handle to the user's state, which keeps it alive    *
+* while held, even if the user is unregistered. Returns nullptr *
+* if the user is not registered.                                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+std::shared_ptr<Client> ServerConnection::GetClient(const int clientSocket)
+{
+    return clients.Find(clientSocket);
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
@@ -565,6 +2280,12 @@ void ServerConnection::ShutDownGame(Game* game)
         }
     }
 
-    // drop the game from the list
-    games.erase(game->name);
+    // drop the game from the lobby before freeing its name, so a new game of the same name
+    // can't be listed first and then dropped in its place
+    {
+        std::lock_guard<std::mutex> guard(game->seatEvents.lock);
+        game->isOpen = false;
+        UpdateLobby(*game);
+    }
+    RemoveGame(*game);
 }
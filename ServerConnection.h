@@ -7,18 +7,24 @@
 #include <string.h>
 #include <unordered_map>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <atomic>
+#include <cstdint>
+#include "TableEngine.h"
+#include "Registry.h"
+#include "MatchQueue.h"
+#include "WireFormat.h"
+#include "Card.h"
+#include "Hand.h"
+#include "ShoePool.h"
 
 /*===============================================================
 ||                       Public Constants                      ||
 ===============================================================*/
 const int PLAYER_COUNT = 2;             // The number of players per room
-const int NUM_DECKS = 8;                // The max name of a room name
-const int CARDS_IN_STANDARD_DECK = 52;  // The number of cards in a standard deck
-// A standard deck of cards
-const std::string STANDARD_DECK[] = {"2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A",
-                                    "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A",
-                                    "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A",
-                                    "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A"};
 const int STARTING_MONEY = 100;         // The starting money of a player
 
 /*===============================================================
@@ -37,7 +43,7 @@ struct StateData
     // The bet each player placed (last spot is dealer, unused)
     int playerBets[PLAYER_COUNT + 1];
     // The hand each player and dealer has
-    std::vector<std::string> shownCards[PLAYER_COUNT + 1];
+    Hand shownCards[PLAYER_COUNT + 1];
 };
 
 // Header so that a pointer can be used in the Client struct
@@ -48,15 +54,46 @@ struct Client
 {
     // --- server management vars ---
     int socket = -1;            // The client's TCP socket
-    Game* curGame = nullptr;    // The client's game
+    // The client's game. Cleared by ExitGame(), which also frees the client's seat
+    std::shared_ptr<Game> curGame;
+    bool isSeatAnswered = false;// True: Client was told they have their seat, so their table can send to them. Guarded by the seat lock
+    bool hasCreatedGame = false;// True: Client created the game they join next; False: Client is joining someone else's game
+    bool isSubscribed = false;  // True: Client is pushed lobby changes; False: Client only sees the lobby when they ask
+    int protocol = 1;           // The protocol version agreed with the client. Clients that never ask stay on 1
+    std::string payload;        // What followed the code of the last protocol 2 request, read by its handler
+    bool hasPayload = false;    // True: The last request carried a payload that has not been read yet
 
     // --- game management vars ---
     int money = 0;          // The client's money
     int mostRecentBet = 0; // The client's most recent bet
     bool hasStood = false;  // True: Client has stood this round; False: Client has not stood this round;
     bool hasBusted = false; // True: Client has busted this round; False: Client has not busted this round;
-    std::string hiddenCard; // The client's face down cards
-    std::vector<std::string> shownCards;    // The client's face up cards
+    Card hiddenCard = NO_CARD;  // The client's face down card
+    Hand shownCards;            // The client's face up cards
+
+    // --- state stream vars ---
+    int statesSent = 0;         // The sequence number of the last state sent to the client
+    int statesConfirmed = 0;    // The highest state sequence number the client has confirmed
+    bool needsFullState = true; // True: Send the whole state next; False: Send what changed since lastStateSent
+    // The state the client has after reading the last state sent. Shared by every client sent the same broadcast
+    std::shared_ptr<const StateData> lastStateSent;
+    std::deque<std::string> heldRequests;   // Requests read while waiting for a confirmation
+};
+
+// The stages a table moves through. A table waits for its seats to fill, then loops
+// from betting to payout until every player leaves.
+enum TableState {WAITING_FOR_PLAYERS, BETTING, PLAYING, DEALER, PAYOUT, CLOSED};
+
+// How a table deals. SHOE_DEALING deals each shuffled shoe in order and changes shoes
+// once SHOE_CUT cards are dealt. CONTINUOUS_DEALING draws every card at random from
+// one shoe that discards go back into, like a continuous shuffling machine.
+enum DealingMode {SHOE_DEALING, CONTINUOUS_DEALING};
+
+// Lets a table sleep until a player takes or leaves a seat
+struct SeatEvents
+{
+    std::mutex lock;            // Guards the game's players and waitingTable
+    TableWaiter waitingTable;   // The table parked until a seat is taken or left
 };
 
 // A game hosted by the server
@@ -64,27 +101,69 @@ struct Game
 {
     // --- server management vars ---
     std::string name = "";  // The name of the game
-    // The players connected to this game (nullptr if not connected)
-    Client **players = new Client*[PLAYER_COUNT];
-    bool isOpen = true;     // Is the game available to join
+    int id = -1;            // The table id the game is known by once it is made. Never given to another game
+    // The players connected to this game (nullptr if not connected). A seated
+    // player stays alive until their seat is cleared, so the table can read them freely
+    std::shared_ptr<Client> players[PLAYER_COUNT];
+    std::atomic<bool> isOpen = true;    // Is the game available to join
+    SeatEvents seatEvents;  // Wakes the table when the players change
+    TableState state = WAITING_FOR_PLAYERS; // The stage the table is in
+    bool isWarm = false;    // True: The table was started before anyone sat, and waits for its first player
 
     // --- game management vars ---
-    // The deck used to decide what card to deal to each player
-    std::string deck[NUM_DECKS * CARDS_IN_STANDARD_DECK];
+    // The deck used to decide what card to deal to each player. Points into shoes
+    Card *deck = nullptr;
     // The index of the deck to deal next (reset to 0 after a shuffle)
     int deckIterator = -1;
+    // The shoe being dealt and the spare shuffled in the background. Given its own random stream by AddGame()
+    std::shared_ptr<ShoeSupply> shoes = std::make_shared<ShoeSupply>();
+    int randomStream = -1;  // The stream the shoes started as, so the table's shoes can be dealt again
+    DealingMode dealingMode = SHOE_DEALING; // How the table deals. Set by AddGame()
     // True: Dealer has stood this round; False: Dealer has not stood this round;
     bool hasStood = false;
     // True: Dealer has busted this round; False: Dealer has not busted this round;
     bool hasBusted = false;
-    // The dealer's face down cards
-    std::string hiddenCard;
+    // The dealer's face down card
+    Card hiddenCard = NO_CARD;
     // The dealer's face up cards
-    std::vector<std::string> shownCards;
+    Hand shownCards;
+
+    // Games are only ever handled through the server's handles, never copied
+    Game() = default;
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
+};
+
+// The list of open games as sent to lobby clients. Built at most once per change to the
+// games, and never changed after, so any number of threads can send it at once
+struct LobbySnapshot
+{
+    uint64_t version = 0;   // The lobby version the list was built for
+    std::string list;       // The list, formatted for the client
+    std::string subscription;   // The open games and their seats taken, as sent to new subscribers
+};
+
+// An open game as kept in the lobby index
+struct LobbyEntry
+{
+    int tableId;        // The game's table id
+    int seatsTaken;     // The players seated in the game
+};
+
+// The lobby changes waiting to be pushed to the subscribers of one lobby thread. Changes
+// are gathered for LOBBY_TICK_MS and then sent to every subscriber as one message
+struct LobbyFeed
+{
+    int ticker = -1;                    // Goes off when the gathered changes are due to be sent
+    std::atomic<int> subscriberCount = 0;   // The number of subscribers, readable from any thread
+    std::mutex lock;                    // Guards pending
+    std::string pending;                // The changes gathered since the last send
+    bool isCollapsed = false;           // True if pending is one LOBBY_CHANGED line standing in for the tick's changes
+    std::vector<int> subscribers;       // The subscribed clients. Only used by the lobby thread
 };
 
 // The possible actions a client could request
-enum Action {LIST, CREATE, JOIN, EXIT, UNREGISTER, BET, HIT, STAND, NONE};
+enum Action {PROTOCOL, LIST, SUBSCRIBE, SEARCH, CREATE, JOIN, JOINTABLE, QUICKJOIN, EXIT, UNREGISTER, BET, HIT, STAND, NONE};
 
 // A class that handles the server's connections and game states. 
 // This including it's TCP socket, UDP socket, client states, 
@@ -97,33 +176,78 @@ class ServerConnection
         ===============================================================*/
         const char* SERVER_TRUE = "TTTTTTTT";       // The response from the server if an action was valid
         const char* SERVER_FALSE = "FFFFFFFF";      // The response from the server if an action was invalid
+        const char* PROTOCOL_REQUEST = "PROTOCOL";  // The client request to speak a newer protocol, followed by the newest it speaks
 
         const char* LIST_GAME_REQUEST = "LISTGAME"; // The client request to see all available games
+        const char* SUBSCRIBE_REQUEST = "SUBSCRIB"; // The client request to be pushed changes to the available games
+        const char* LOBBY_SNAPSHOT = "LOBBYSUB";    // Starts the list of games sent to a new subscriber
+        const char* LOBBY_EVENTS = "LOBBYEVT";      // Starts a message of lobby changes pushed to subscribers
+        const char* GAME_LISTED = "+";              // Starts a lobby line for an open game, followed by its seats taken and name
+        const char* GAME_UNLISTED = "-";            // Starts a lobby line for a game no longer open, followed by its name
+        const char* LOBBY_CHANGED = "*";            // A lobby line standing in for a tick's changes too many to push, followed by the lobby version
+        const int LOBBY_TICK_MS = 100;              // How long lobby changes are gathered before they are pushed
+        const size_t MAX_LOBBY_PUSH_SIZE = 65536;   // The biggest lobby push clients can read, matching MAX_FRAME_SIZE
+        const char* SEARCH_REQUEST = "SEARCHGM";    // The client request for a page of the open games matching a search
+        const char FREE_SEATS_ONLY = 'F';           // Starts a search for only the games with a seat free
+        const int LOBBY_PAGE_SIZE = 16;             // The most games sent in any one lobby message
         const char* CREATE_REQUEST = "CREATEGM";    // The client request to create a game
         const char* JOIN_REQUEST = "JOINGAME";      // The client request to join a game
+        const char* JOIN_TABLE_REQUEST = "JOINTBID";// The client request to join a game by its table id
+        const char* QUICK_JOIN_REQUEST = "QUICKJON";// The client request to be seated at whichever table has a seat next
+        const char* QUICK_TABLE_NAME = "quick";     // Starts the name of each table made for matchmaking
+        const size_t QUICK_JOIN_QUEUE_SIZE = 4096;  // The most clients waiting on matchmaking at once
         const char* EXIT_REQUEST = "EXITGAME";      // The client request to be removed from the game
         const char* UNREGISTER_REQUEST = "UNREGIST";// The client request to unregister from the server
         const char* BET_REQUEST = "BET00000";       // The client request to bet
         const char* HIT_REQUEST = "HIT00000";       // The client request to hit
         const char* STAND_REQUEST = "STAND000";     // The client request to stand
+        const char* STATE_CONFIRM = "ACKSTATE";     // The client confirming states, followed by the last sequence number read
+        const char* STATE_RESYNC = "RESYNCST";      // The client asking for the whole state to be sent again
+        const char* FULL_STATE = "S";               // Marks a state frame holding the whole state
+        const char* CHANGED_STATE = "D";            // Marks a state frame holding only what changed since the last
+        const int STATE_HEADER_CODE_SIZE = 6;       // The largest protocol 2 state header: its code, sequence number, and seat
+        const int STATE_CODE_BUFFER_SIZE = 1024;    // The size a protocol 2 state body is encoded into. Far more than any state needs
 
         // The size of a clien't request
         const int CLIENT_ACTION_LENGTH = sizeof(LIST_GAME_REQUEST);
 
         const int ROOM_NAME_BUFFER_SIZE = 1024;     // The max size to read a room name from a socket
-        const int BET_BUFFER_SIZE = 1024;           // The max size to read a bet from a socket
+        const int REQUEST_BUFFER_SIZE = 1024;       // The max size to read any one message from a socket
+        const int STATE_WINDOW = 16;                // The most states a client may have unconfirmed
 
         /*===============================================================
         ||                      Private Variables                      ||
         ===============================================================*/
 
-        // The games the server is hosting. The game name is used as the key
-        std::unordered_map<std::string, Game> games;
+        // The games the server is hosting. The table id is used as the key
+        Registry<int, Game> games;
+        // The table id of each game. The game name is used as the key, and is only
+        // looked up to make a game or join one by name
+        Registry<std::string, int> tableIds;
+        std::atomic<int> tableCount = 0;    // The number of games ever made, used to give each its table id
         // The clients the server is handling. The client socket is used as the key
-        std::unordered_map<int, Client> clients;
+        Registry<int, Client> clients;
 
         int udpConnection;  // The discovery socket for the sever
-        int tcpConnection;  // The game socket connection socket
+        std::vector<int> tcpConnections;    // The game sockets clients connect to, one per lobby thread
+        std::mutex tcpConnectionsLock;      // Guards tcpConnections
+
+        // The list of open games sent for LISTGAME. Swapped for a new one once it is out of date
+        std::atomic<std::shared_ptr<const LobbySnapshot>> lobbySnapshot;
+        std::atomic<uint64_t> lobbyVersion = 1; // Counts up each time a game opens, closes, or has its seats change
+        std::mutex lobbyPublishLock;        // Makes rebuilds of lobbySnapshot take turns
+        std::vector<std::unique_ptr<LobbyFeed>> lobbyFeeds;  // One for each lobby thread
+        std::mutex lobbyFeedsLock;          // Guards lobbyFeeds
+        std::map<std::string, LobbyEntry> lobbyIndex;   // Each open game's table id and seats taken, in name order
+        std::mutex lobbyIndexLock;          // Guards lobbyIndex, and is held while lobbyVersion counts up
+        MatchQueue<int> quickJoins{QUICK_JOIN_QUEUE_SIZE};  // The clients waiting to be seated by matchmaking
+        int quickJoinSignal;                // Raised each time a client is added to quickJoins
+        std::atomic<int> quickTableCount = 0;   // The number of tables made for matchmaking, used to name them
+        ShoeRandom nextStream;              // The stream the next game is given, jumped ahead after each
+        int streamCount = 0;                // The number of streams given out
+        bool isLoggingSeeds = false;        // True: Log the seed and each game's stream; False: Don't
+        DealingMode dealingMode = SHOE_DEALING; // How the games made from now on deal
+        std::mutex streamLock;              // Guards nextStream, streamCount, isLoggingSeeds, and dealingMode
 
 
         /*===============================================================
@@ -151,31 +275,158 @@ class ServerConnection
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                       NextOpenSeatInRoom                      *
         *------------------------- Description -------------------------*
-        * Given a room name, get the next open seat index.              *
+        * Given a room, get the next open seat index. Call while holding*
+        * the room's seat lock.                                         *
         *                                                               *
         *------------------------- Parameters --------------------------*
-        * const std::string name: The name of the room to check.        *
+        * const Game &game: The room to check.                          *
         *                                                               *
         *------------------------- Return Value ------------------------*
         * Return the index of the next open seat. Returns -1 if there   *
-        * are no open seats, if the room is closed, or if the room      *
-        * doesn't exist.                                                *
+        * are no open seats or if the room is closed.                   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int NextOpenSeatInRoom(const Game &game);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        SeatsTakenInRoom                       *
+        *------------------------- Description -------------------------*
+        * Given a room, count the players seated in it. Call while      *
+        * holding the room's seat lock.                                 *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Game &game: The room to check.                          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Return the number of seats taken.                             *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int SeatsTakenInRoom(const Game &game);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           SeatClient                          *
+        *------------------------- Description -------------------------*
+        * Give the client the next open seat in a room, if it has one,  *
+        * so two clients can't take the same seat. Does not tell the    *
+        * client or wake the table.                                     *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::shared_ptr<Client> &client: The client to seat.    *
+        *                                                               *
+        * const std::shared_ptr<Game> &game: The room to seat them in.  *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the client was seated.                        *
+        * Returns false if the room has no open seat.                   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SeatClient(const std::shared_ptr<Client> &client, const std::shared_ptr<Game> &game);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                            JoinRoom                           *
+        *------------------------- Description -------------------------*
+        * Seat the client in the room they asked to join, tell them if  *
+        * they were seated, and wake the room's table.                  *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * const std::shared_ptr<Game> &game: The room asked for. nullptr*
+        *   if no room matched the request.                             *
+        *                                                               *
+        * bool &isSeated: Set to true if the client was given a seat,   *
+        *   and has left the lobby.                                     *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool JoinRoom(const int clientSocket, const std::shared_ptr<Game> &game, bool &isSeated);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                            AddGame                            *
+        *------------------------- Description -------------------------*
+        * Give a new game the next table id and start hosting it, unless*
+        * its name is already taken.                                    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::shared_ptr<Game> &game: The game to add. Its name  *
+        *   must be set.                                                *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the game was added.                           *
+        * Returns false if another game has the name.                   *
         *                                                               *
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-        int NextOpenSeatInRoom(const std::string name);
+        bool AddGame(const std::shared_ptr<Game> &game);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           GiveStream                          *
+        *------------------------- Description -------------------------*
+        * Give a new game the next random stream to shuffle with and    *
+        * how to deal, log it if seeds are being logged, and queue its  *
+        * first shoe if it deals from shoes.                            *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * Game &game: The game to give the stream. Its table id must be *
+        *   set.                                                        *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void GiveStream(Game &game);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           RemoveGame                          *
+        *------------------------- Description -------------------------*
+        * Stop hosting a game, freeing its name for a new game.         *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Game &game: The game to remove.                         *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void RemoveGame(const Game &game);
 
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                         GetListOfGames                        *
         *------------------------- Description -------------------------*
-        * Get a list of each open game name.                            *
+        * Get a list of the first LOBBY_PAGE_SIZE open game names, in   *
+        * name order. Call while holding lobbyIndexLock.                *
         *                                                               *
         *------------------------- Parameters --------------------------*
         * std::string &list: The string to replace with the list of open*
         *   games, formatted for the client to list. If no games are    *
-        *   present, sets the string to: "<no games>\n"                 *
+        *   open, sets the string to: "<no games>\n"                    *
+        *                                                               *
+        * std::string &subscription: The string to add the same games   *
+        *   and their seats taken to, one per line, as sent to new lobby*
+        *   subscribers.                                                *
         *                                                               *
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-        void GetListOfGames(std::string &list);
+        void GetListOfGames(std::string &list, std::string &subscription);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         GetPageOfGames                        *
+        *------------------------- Description -------------------------*
+        * Get up to LOBBY_PAGE_SIZE open games whose names start with a *
+        * prefix, in name order. Call while holding lobbyIndexLock.     *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::string &prefix: What each name must start with.    *
+        *                                                               *
+        * const bool freeSeatsOnly: True: Skip games with no free seat. *
+        *                                                               *
+        * const std::string &after: Start after this name. Empty to     *
+        *   start at the first match.                                   *
+        *                                                               *
+        * std::string &page: The string to add each game's seats taken, *
+        *   table id and name to, one per line.                         *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the name to start the next page after. Returns an     *
+        * empty string if this is the last page.                        *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::string GetPageOfGames(const std::string &prefix, const bool freeSeatsOnly, const std::string &after, std::string &page);
 
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                         DoesGameExist                         *
@@ -192,6 +443,277 @@ class ServerConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         bool DoesGameExist(const std::string name);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        EncodeStateHeader                      *
+        *------------------------- Description -------------------------*
+        * Format the part of a state frame that differs per client: the *
+        * sequence number, the kind of frame, and for a whole state the *
+        * index of the player it is sent to.                            *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int sequence: The number of this state for the client.  *
+        *                                                               *
+        * const bool isFullState: True: The body is the whole state;    *
+        *   False: The body is what changed since the last state.       *
+        *                                                               *
+        * const int playerIndex: The index of the client's seat.        *
+        *                                                               *
+        * std::string &data: The string to replace with the header.     *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void EncodeStateHeader(const int sequence, const bool isFullState, const int playerIndex, std::string &data);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        EncodeStateData                        *
+        *------------------------- Description -------------------------*
+        * Format a game state the way the client expects to read it.    *
+        * The player index is left to EncodeStateHeader(), so one body  *
+        * can be sent to every seat.                                    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const StateData &state: The state of the game.                *
+        *                                                               *
+        * std::string &data: The string to replace with the formatted   *
+        *   state.                                                      *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void EncodeStateData(const StateData &state, std::string &data);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        EncodeStateChanges                     *
+        *------------------------- Description -------------------------*
+        * Format only what changed between two game states: the turn,   *
+        * the new round flag, then each seat whose money or bet changed,*
+        * each card added to a hand, and each hand that was replaced.   *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const StateData &previous: The state the client already has.  *
+        *                                                               *
+        * const StateData &state: The state of the game.                *
+        *                                                               *
+        * std::string &data: The string to replace with the formatted   *
+        *   changes.                                                    *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void EncodeStateChanges(const StateData &previous, const StateData &state, std::string &data);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      EncodeStateHeaderCodes                   *
+        *------------------------- Description -------------------------*
+        * Format the header EncodeStateHeader() makes, for protocol 2:  *
+        * the frame code, the sequence number as an integer, and for a  *
+        * whole state the player's seat as one byte.                    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int sequence: The number of this state for the client.  *
+        *                                                               *
+        * const bool isFullState: True: The body is the whole state;    *
+        *   False: The body is what changed since the last state.       *
+        *                                                               *
+        * const int playerIndex: The index of the client's seat.        *
+        *                                                               *
+        * char data[]: Where the header is written. At least            *
+        *   STATE_HEADER_CODE_SIZE long.                                *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the number of bytes written.                          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int EncodeStateHeaderCodes(const int sequence, const bool isFullState, const int playerIndex, char data[]);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         EncodeStateCodes                      *
+        *------------------------- Description -------------------------*
+        * Format a game state for protocol 2 in one pass: the turn and  *
+        * new round flag as a byte each, the money and bets as integers,*
+        * then each hand as its card count and a code per card.         *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const StateData &state: The state of the game.                *
+        *                                                               *
+        * char data[]: Where the state is written. At least             *
+        *   STATE_CODE_BUFFER_SIZE long.                                *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the number of bytes written.                          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int EncodeStateCodes(const StateData &state, char data[]);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      EncodeStateChangeCodes                   *
+        *------------------------- Description -------------------------*
+        * Format the changes EncodeStateChanges() finds, for protocol 2.*
+        * Each change is its code and seat as a byte each, then an      *
+        * integer for money and bets, or a card count and a code per    *
+        * card for hands.                                               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const StateData &previous: The state the client already has.  *
+        *                                                               *
+        * const StateData &state: The state of the game.                *
+        *                                                               *
+        * char data[]: Where the changes are written. At least          *
+        *   STATE_CODE_BUFFER_SIZE long.                                *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the number of bytes written.                          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int EncodeStateChangeCodes(const StateData &previous, const StateData &state, char data[]);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          EncodeCards                          *
+        *------------------------- Description -------------------------*
+        * Write part of a hand for protocol 2: the number of cards, then*
+        * a code per card.                                              *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Hand &hand: The hand.                                   *
+        *                                                               *
+        * const int firstCard: The index of the first card to write.    *
+        *                                                               *
+        * char data[]: Where the cards are written.                     *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the number of bytes written.                          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int EncodeCards(const Hand &hand, const int firstCard, char data[]);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        HandleStateMessage                     *
+        *------------------------- Description -------------------------*
+        * Apply a state confirmation or resync request from the client. *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * Client &client: The client that sent the message.             *
+        *                                                               *
+        * const char message[]: The message read from the client.       *
+        *                                                               *
+        * const int length: The number of bytes in message.             *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the message was about the state stream.       *
+        * Returns false if the message is some other request.           *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool HandleStateMessage(Client &client, const char message[], const int length);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      ReadRequestFromClient                    *
+        *------------------------- Description -------------------------*
+        * Read the next request from the client. State confirmations and*
+        * resync requests are applied and skipped, and requests held    *
+        * back while waiting for a confirmation are returned first.     *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * char buffer[]: Where the request will be placed.              *
+        *                                                               *
+        * const int bufferSize: The size of buffer.                     *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool ReadRequestFromClient(const int clientSocket, char buffer[], const int bufferSize);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      ReadRequestFromClient                    *
+        *------------------------- Description -------------------------*
+        * Read the next request from the client, and say how long it is.*
+        * If the last protocol 2 request's payload has not been read, it*
+        * is returned as if it were sent on its own.                    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * char buffer[]: Where the request will be placed. Null         *
+        *   terminated, and cut short if it doesn't fit.                *
+        *                                                               *
+        * const int bufferSize: The size of buffer.                     *
+        *                                                               *
+        * int &length: Set to the number of bytes placed in buffer, not *
+        *   counting the null.                                          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool ReadRequestFromClient(const int clientSocket, char buffer[], const int bufferSize, int &length);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      ReadNumberFromClient                     *
+        *------------------------- Description -------------------------*
+        * Read a number the client sent after a request: as text in     *
+        * protocol 1, or as an integer in protocol 2.                   *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * int &value: Set to the number. 0 if none was sent.            *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool ReadNumberFromClient(const int clientSocket, int &value);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           SendAnswer                          *
+        *------------------------- Description -------------------------*
+        * Tell the client if their action was valid, in the protocol    *
+        * they speak.                                                   *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * const bool isValid: True: The action was valid; False: It was *
+        *   not.                                                        *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SendAnswer(const int clientSocket, const bool isValid);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                       HoldWaitingRequests                     *
+        *------------------------- Description -------------------------*
+        * Take every whole message already read off the client's socket *
+        * without waiting for more. State confirmations and resync      *
+        * requests are applied, and other requests are held for         *
+        * ReadRequestFromClient().                                      *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void HoldWaitingRequests(const int clientSocket);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        HasPayloadMessage                      *
+        *------------------------- Description -------------------------*
+        * Check if a protocol 1 request is followed by a message of its *
+        * own holding what the request is about, such as a name or an   *
+        * amount. In protocol 2 that is part of the request instead.    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const std::string &request: The protocol 1 request.           *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the request's handler reads another message.  *
+        * Returns false if the request stands on its own.               *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool HasPayloadMessage(const std::string &request);
+
     public:
         /*===============================================================
         ||                       Public Functions                      ||
@@ -200,11 +722,41 @@ class ServerConnection
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                          Constructor                          *
         *------------------------- Description -------------------------*
-        * Set up the server's UDP and TCP sockets                       *
+        * Set up the server. Its UDP socket is opened with              *
+        * OpenDiscoverySocket(), and TCP sockets are added with         *
+        * OpenGameSocket().                                             *
         *                                                               *
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         ServerConnection();
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           SeedShoes                           *
+        *------------------------- Description -------------------------*
+        * Set the master seed the games made from now on get their      *
+        * random streams from. The server seeds itself randomly, so this*
+        * is only needed to replay shoes or make a run repeatable.      *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const uint64_t seed: The master seed.                         *
+        *                                                               *
+        * const bool logSeeds: True: Log the seed, and each game's      *
+        *   stream as it is made; False: Don't.                         *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void SeedShoes(const uint64_t seed, const bool logSeeds);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         SetDealingMode                        *
+        *------------------------- Description -------------------------*
+        * Set how the games made from now on deal. Games deal from      *
+        * shoes unless this is called.                                  *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const DealingMode mode: How the games deal.                   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void SetDealingMode(const DealingMode mode);
+
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                          Destructor                           *
         *------------------------- Description -------------------------*
@@ -215,15 +767,64 @@ class ServerConnection
         ~ServerConnection();
 
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
-        *                        AcceptNewClient                        *
+        *                      OpenDiscoverySocket                      *
+        *------------------------- Description -------------------------*
+        * Open the UDP socket clients find the server on. Call once,    *
+        * before any game socket is opened. It fails if another server  *
+        * is already running on this computer, as it would otherwise    *
+        * share the game port and be handed some of the clients.        *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the socket is open. Returns false if it could *
+        * not be opened, in which case the server should not start.     *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool OpenDiscoverySocket();
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         OpenGameSocket                        *
+        *------------------------- Description -------------------------*
+        * Open another TCP socket clients can connect to. Every game    *
+        * socket shares the game port, and the kernel spreads new       *
+        * clients across them.                                          *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int backlog: The most clients that may wait to be       *
+        *   accepted on this socket.                                    *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Return an int representing the game socket. Returns -1 if it  *
+        * could not be opened.                                          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int OpenGameSocket(const int backlog);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        AcceptNewClients                       *
         *------------------------- Description -------------------------*
-        * Look for a client to connect to the server.                   *
+        * Accept and register every client waiting on a game socket.    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int gameSocket: A socket from OpenGameSocket().         *
+        *                                                               *
+        * int newSockets[]: Where the new client connections are put.   *
+        *                                                               *
+        * const int maxClients: The most clients to accept.             *
         *                                                               *
         *------------------------- Return Value ------------------------*
-        * Return an int representing the client connection.             *
+        * Return the number of clients accepted.                        *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int AcceptNewClients(const int gameSocket, int newSockets[], const int maxClients);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        AnswerDiscovery                        *
+        *------------------------- Description -------------------------*
+        * Answer clients looking for the server over UDP. Never returns,*
+        * so run it on its own thread.                                  *
         *                                                               *
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-        int AcceptNewClient();
+        void AnswerDiscovery();
 
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                     InterpretClientRequest                    *
@@ -240,10 +841,67 @@ class ServerConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         Action InterpretClientRequest(const int clientSocket);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                       NegotiateProtocol                       *
+        *------------------------- Description -------------------------*
+        * Recive the newest protocol version the client speaks, answer  *
+        * with the version both sides speak, and use it for the rest of *
+        * the connection.                                               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool NegotiateProtocol(const int clientSocket);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        HasClientRequest                       *
+        *------------------------- Description -------------------------*
+        * Check, without waiting, if the client has a whole request     *
+        * ready for InterpretClientRequest() and the request's handler. *
+        * Only messages already read off the socket are looked at. A    *
+        * protocol 1 request with a payload needs both its messages.    *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the next request can be read without waiting. *
+        *   Also true if the client is gone, so callers stop waiting.   *
+        * Returns false if more has to be read from the client first.   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool HasClientRequest(const int clientSocket);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         HasStateWindow                        *
+        *------------------------- Description -------------------------*
+        * Check, without waiting, if the client can be sent another     *
+        * state without falling STATE_WINDOW states behind. Only        *
+        * confirmations already read off the socket are counted.        *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if a state can be sent without waiting.          *
+        *   Also true if the client is gone, so callers stop waiting.   *
+        * Returns false if more has to be read from the client first.   *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool HasStateWindow(const int clientSocket);
+
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                           ListGames                           *
         *------------------------- Description -------------------------*
-        * Send the client a list of all the games available to join.    *
+        * Send the client a list of the first LOBBY_PAGE_SIZE games     *
+        * available to join, in name order. The rest can be found with  *
+        * SearchGames(). The list is built ahead of time, so sending it *
+        * is one write.                                                 *
         *                                                               *
         *------------------------- Parameters --------------------------*
         * const int clientSocket: The client to handle.                 *
@@ -255,6 +913,122 @@ class ServerConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         bool ListGames(const int clientSocket);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          UpdateLobby                          *
+        *------------------------- Description -------------------------*
+        * Record the game's change in the lobby index, mark the list of *
+        * open games out of date, and queue the change for lobby        *
+        * subscribers. Call after a game opens, closes, or has a seat   *
+        * taken or freed, holding the game's seat lock if it is open,   *
+        * and before a closed game is removed. The list is rebuilt the  *
+        * next time it is asked for, so a burst of changes costs one    *
+        * rebuild. A tick with more changes than one push can hold is   *
+        * queued as a single sign that the lobby changed.               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const Game &game: The game that changed.                      *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void UpdateLobby(const Game &game);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         OpenLobbyFeed                         *
+        *------------------------- Description -------------------------*
+        * Set up the lobby changes pushed to one lobby thread's         *
+        * subscribers. The feed's ticker must be watched by that thread,*
+        * which calls SendLobbyEvents() each time it goes off.          *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the feed, which lasts as long as the server. Returns  *
+        * nullptr if its ticker could not be made.                      *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        LobbyFeed* OpenLobbyFeed();
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        SubscribeToLobby                       *
+        *------------------------- Description -------------------------*
+        * Send the client every open game and its seats taken, then push*
+        * them each change from then on until they leave the lobby.     *
+        * Call from the lobby thread the feed belongs to.               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * LobbyFeed *feed: The feed of the client's lobby thread.       *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SubscribeToLobby(const int clientSocket, LobbyFeed *feed);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                          SearchGames                          *
+        *------------------------- Description -------------------------*
+        * Recive a search from the client and send them one page of the *
+        * open games that match it. The search is whether only games    *
+        * with a free seat are wanted, then the prefix the names must   *
+        * start with and the name to start after, split by '\n'. The    *
+        * page is the name to start the next page after (empty on the   *
+        * last page), then each game's seats taken, table id and name,  *
+        * one per line.                                                 *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SearchGames(const int clientSocket);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                      UnsubscribeFromLobby                     *
+        *------------------------- Description -------------------------*
+        * Stop pushing lobby changes to the client. Does nothing if they*
+        * are not subscribed. Call from the lobby thread the feed       *
+        * belongs to before the client leaves it.                       *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * LobbyFeed *feed: The feed of the client's lobby thread.       *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void UnsubscribeFromLobby(const int clientSocket, LobbyFeed *feed);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        SendLobbyEvents                        *
+        *------------------------- Description -------------------------*
+        * Push the lobby changes gathered since the last send to every  *
+        * subscriber of the feed as one message, encoded once. A        *
+        * message too big for clients to read is cut down to a sign     *
+        * that the lobby changed. Clients that can't be sent to are     *
+        * unsubscribed. Call from the lobby thread the feed belongs to  *
+        * when its ticker goes off.                                     *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * LobbyFeed *feed: The feed to send.                            *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void SendLobbyEvents(LobbyFeed *feed);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        GetLobbySnapshot                       *
+        *------------------------- Description -------------------------*
+        * Get the current list of open games, publishing a new one first*
+        * if the games have changed since the last was built.           *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the list. It never changes, and stays valid for as    *
+        * long as it is held, even once a newer list replaces it.       *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::shared_ptr<const LobbySnapshot> GetLobbySnapshot();
+
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                          CreateGame                           *
         *------------------------- Description -------------------------*
@@ -280,12 +1054,105 @@ class ServerConnection
         *------------------------- Parameters --------------------------*
         * const int clientSocket: The client to handle.                 *
         *                                                               *
+        * bool &isSeated: Set to true if the client was given a seat,   *
+        *   and has left the lobby.                                     *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool JoinGame(const int clientSocket, bool &isSeated);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           JoinTable                           *
+        *------------------------- Description -------------------------*
+        * Recive a table id from the client, as listed by SearchGames(),*
+        * and add them to the game if able.                             *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * bool &isSeated: Set to true if the client was given a seat,   *
+        *   and has left the lobby.                                     *
+        *                                                               *
         *------------------------- Return Value ------------------------*
         * Returns true if the connection to the client is still active. *
         * Returns false if the connection to the client has terminated. *
         *                                                               *
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-        bool JoinGame(const int clientSocket);
+        bool JoinTable(const int clientSocket, bool &isSeated);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           QuickJoin                           *
+        *------------------------- Description -------------------------*
+        * Add the client to the matchmaking queue. They are answered    *
+        * once SeatQuickJoiner() gives them a seat, or right away if the*
+        * queue is full, in which case they stay in the lobby.          *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * bool &isQueued: Set to true if the client is now waiting on   *
+        *   matchmaking, and has left the lobby.                        *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the connection to the client is still active. *
+        * Returns false if the connection to the client has terminated. *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool QuickJoin(const int clientSocket, bool &isQueued);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        WaitForQuickJoins                      *
+        *------------------------- Description -------------------------*
+        * Sleep until clients are waiting on matchmaking, then take as  *
+        * many of them as fit, oldest first. Call from one matchmaking  *
+        * thread.                                                       *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * int clientSockets[]: Where the waiting clients are placed.    *
+        *                                                               *
+        * const int maxClients: The most clients to take at once.       *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the number of clients taken. Always at least one.     *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        int WaitForQuickJoins(int clientSockets[], const int maxClients);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                         OpenQuickTable                        *
+        *------------------------- Description -------------------------*
+        * Make an open game for matchmaking to seat clients at, named   *
+        * QUICK_TABLE_NAME and a number. The game is warm: its table can*
+        * be started before anyone sits, and it waits for its first     *
+        * player instead of closing.                                    *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the new game.                                         *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::shared_ptr<Game> OpenQuickTable();
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                        SeatQuickJoiner                        *
+        *------------------------- Description -------------------------*
+        * Give a client taken from the matchmaking queue a seat at the  *
+        * game, tell them, and wake the table. If the client is gone,   *
+        * they are removed from the server.                             *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        * const std::shared_ptr<Game> &game: The game to seat them at.  *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns true if the client no longer needs a seat.            *
+        * Returns false if the game had no open seat for them.          *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        bool SeatQuickJoiner(const int clientSocket, const std::shared_ptr<Game> &game);
 
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                           ExitGame                            *
@@ -328,7 +1195,12 @@ class ServerConnection
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                         SendStateData                         *
         *------------------------- Description -------------------------*
-        * Send the current state of the game to a player.               *
+        * Send the current state of the game to a player. Each state is *
+        * numbered, and the client confirms them in groups. This never  *
+        * waits: a client STATE_WINDOW states behind is skipped, so     *
+        * wait for its window first. Only what changed since the last   *
+        * state is sent, unless the client just joined or asked to      *
+        * resync.                                                       *
         *                                                               *
         *------------------------- Parameters --------------------------*
         * const int clientSocket: The client to handle.                 *
@@ -342,6 +1214,31 @@ class ServerConnection
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
         bool SendStateData(const int clientSocket, const StateData &state);
 
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                     SendStateDataToPlayers                    *
+        *------------------------- Description -------------------------*
+        * Send one game state to several players in one batch. The body *
+        * is encoded once per kind of frame and shared by every player, *
+        * and only a small header is made per player. Never waits on a  *
+        * confirmation: a player STATE_WINDOW states behind is skipped, *
+        * so callers wait for every window first.                       *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSockets[]: The clients to send to.            *
+        *                                                               *
+        * const int playerIndexes[]: The seat of each client.           *
+        *                                                               *
+        * const StateData &state: The state of the game. Its            *
+        *   playerIndex is ignored.                                     *
+        *                                                               *
+        * const int count: The number of clients.                       *
+        *                                                               *
+        * bool stillConnected[]: Set to true for each client whose      *
+        *   connection is still active, false otherwise.                *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void SendStateDataToPlayers(const int clientSockets[], const int playerIndexes[], const StateData &state, const int count, bool stillConnected[]);
+
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                          GetUserGame                          *
         *------------------------- Description -------------------------*
@@ -351,10 +1248,28 @@ class ServerConnection
         * const int clientSocket: The client to handle.                 *
         *                                                               *
         *------------------------- Return Value ------------------------*
-        * Returns a pointer to the game a user is apart of.             *
+        * Returns a handle to the game a user is apart of, which keeps  *
+        * the game alive while held. Returns nullptr if the user is not *
+        * in a game or is not registered.                               *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        std::shared_ptr<Game> GetUserGame(const int clientSocket);
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                           GetClient                           *
+        *------------------------- Description -------------------------*
+        * Find the state of a given user.                               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const int clientSocket: The client to handle.                 *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns a handle to the user's state, which keeps it alive    *
+        * while held, even if the user is unregistered. Returns nullptr *
+        * if the user is not registered.                                *
         *                                                               *
         *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
-        Game* GetUserGame(const int clientSocket);
+        std::shared_ptr<Client> GetClient(const int clientSocket);
 
         /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
         *                          ShutDownGame                         *
@@ -0,0 +1,249 @@
+#include "ShoePool.h"   // My H file
+#include "ServerAPI.h"      // StartSignal, RaiseSignal, WaitForSignal
+#include <pthread.h>        // pthread_create
+#include <sched.h>          // sched_yield
+#include <cstring>          // memcpy
+#include <deque>
+#include <mutex>
+
+/*===============================================================
+||                      Private Variables                      ||
+===============================================================*/
+std::mutex queueLock;                           // Guards queuedShoes
+std::deque<std::shared_ptr<ShoeSupply>> queuedShoes;// Tables with a spare shoe to shuffle, oldest first
+int queueSignal = -1;   // Raised when a shoe is queued. Set up once by StartShoePool()
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          ShuffleSpare                         *
+*------------------------- Description -------------------------*
+* Refill a table's spare shoe and shuffle it, unless another    *
+* thread already has. Claiming the spare first means the table  *
+* and the pool never shuffle the same shoe, or use the table's  *
+* random stream, at the same time.                              *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes.                        *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if the spare was shuffled by this call.          *
+* Returns false if it is being shuffled or is already shuffled. *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool ShuffleSpare(ShoeSupply &supply)
+{
+    int stage = SHOE_QUEUED;
+    if (!supply.spareStage.compare_exchange_strong(stage, SHOE_SHUFFLING, std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    // every shoe starts from the standard order, so each shuffle stands on its own
+    Card *spare = supply.shoes[1 - supply.dealing];
+    memcpy(spare, STANDARD_SHOE.data(), sizeof(supply.shoes[0]));
+    ShuffleCards(spare, SHOE_SIZE, supply.random);
+    supply.spareStage.store(SHOE_READY, std::memory_order_release);
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          RunShoeWorker                        *
+*------------------------- Description -------------------------*
+* The thread function of a shuffling thread. Shuffles queued    *
+* spare shoes oldest first, and sleeps while there are none.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* void *arg: Unused.                                            *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Never returns.                                                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void *RunShoeWorker([[maybe_unused]] void *arg)
+{
+    while (true)
+    {
+        std::shared_ptr<ShoeSupply> supply;
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            if (!queuedShoes.empty())
+            {
+                supply = std::move(queuedShoes.front());
+                queuedShoes.pop_front();
+
+                // one raise can stand for many shoes, so wake another thread for the rest
+                if (!queuedShoes.empty())
+                {
+                    RaiseSignal(queueSignal);
+                }
+            }
+        }
+
+        if (supply == nullptr)
+        {
+            WaitForSignal(queueSignal);
+            continue;
+        }
+        ShuffleSpare(*supply);
+    }
+    return nullptr;
+}
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         StartShoePool                         *
+*------------------------- Description -------------------------*
+* Starts the threads that shuffle spare shoes. Call once before *
+* any tables are made. Without them, tables shuffle their own   *
+* shoes when they change shoes.                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int count: The number of shuffling threads to start.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if every thread started.                         *
+* Returns false if a thread could not be set up.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool StartShoePool(const int count)
+{
+    queueSignal = StartSignal();
+    if (queueSignal < 0)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        pthread_t newWorker;
+        if (pthread_create(&newWorker, NULL, RunShoeWorker, nullptr) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          PrepareShoe                          *
+*------------------------- Description -------------------------*
+* Hand a table's spare shoe to the pool to be refilled and      *
+* shuffled. Safe to call from any thread.                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::shared_ptr<ShoeSupply> &supply: The table's shoes. *
+*   Its random stream must be set.                              *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void PrepareShoe(const std::shared_ptr<ShoeSupply> &supply)
+{
+    // with no pool the table shuffles the spare when it needs it
+    if (queueSignal < 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+        queuedShoes.push_back(supply);
+    }
+    RaiseSignal(queueSignal);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           NextShoe                            *
+*------------------------- Description -------------------------*
+* Move a table on to its spare shoe, and hand the shoe it was   *
+* dealing from to the pool. If the pool hasn't reached the spare*
+* yet, it is shuffled here instead. Only called by the table.   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::shared_ptr<ShoeSupply> &supply: The table's shoes. *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the shuffled cards to deal from, SHOE_SIZE of them.   *
+* They stay in place until the next call.                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+Card *NextShoe(const std::shared_ptr<ShoeSupply> &supply)
+{
+    ShoeSupply &shoes = *supply;
+    if (!ShuffleSpare(shoes))
+    {
+        // the pool has the spare, and a shuffle takes about a microsecond. Yield in
+        // case the shuffling thread was put to sleep partway through
+        while (shoes.spareStage.load(std::memory_order_acquire) != SHOE_READY)
+        {
+            sched_yield();
+        }
+    }
+
+    shoes.dealing = 1 - shoes.dealing;
+    shoes.spareStage.store(SHOE_QUEUED, std::memory_order_release);
+    PrepareShoe(supply);
+    return shoes.shoes[shoes.dealing];
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      FillContinuousShoe                       *
+*------------------------- Description -------------------------*
+* Fill a table's shoe to be dealt from continuously with        *
+* DrawContinuous(). Never call NextShoe() on the same shoes.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void FillContinuousShoe(ShoeSupply &supply)
+{
+    memcpy(supply.shoes[0], STANDARD_SHOE.data(), sizeof(supply.shoes[0]));
+    supply.undealt = SHOE_SIZE;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         DrawContinuous                        *
+*------------------------- Description -------------------------*
+* Deal a card picked at random from the cards not yet dealt. The*
+* card is swapped to the end of the undealt cards, so every draw*
+* costs one random number and one swap.                         *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes, set up with            *
+*   FillContinuousShoe(). At least one card must be undealt.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the card dealt.                                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+Card DrawContinuous(ShoeSupply &supply)
+{
+    int picked = supply.random.Below(supply.undealt);
+    supply.undealt--;
+    Card card = supply.shoes[0][picked];
+    supply.shoes[0][picked] = supply.shoes[0][supply.undealt];
+    supply.shoes[0][supply.undealt] = card;
+    return card;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ReturnDiscards                        *
+*------------------------- Description -------------------------*
+* Put every dealt card back into a continuous shoe. The dealt   *
+* cards are already held after the undealt ones, so this only   *
+* moves the boundary. Call once no cards are in play.           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes, set up with            *
+*   FillContinuousShoe().                                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ReturnDiscards(ShoeSupply &supply)
+{
+    supply.undealt = SHOE_SIZE;
+}
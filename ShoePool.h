@@ -0,0 +1,141 @@
+#ifndef SHOEPOOL_H
+#define SHOEPOOL_H
+#include <array>            // array
+#include <atomic>           // atomic
+#include <memory>           // shared_ptr
+#include "Card.h"           // Card, MakeShoe, CARDS_IN_STANDARD_DECK
+#include "ShoeRandom.h"     // ShoeRandom
+
+// Shuffles table shoes on background threads, so a table changing shoes between
+// rounds swaps a pointer instead of waiting on a shuffle. Each table keeps one
+// spare shoe beside the shoe it is dealing from. Once the table moves on to the
+// spare, the old shoe is handed to the pool to be refilled and shuffled while
+// the table plays. Every shoe is shuffled with the table's own random stream, in
+// the order the table deals them, so seeded shoes still come out the same.
+//
+// A table can instead deal like a continuous shuffling machine. It keeps one shoe
+// and draws each card at random from the cards not yet dealt, one step of a
+// Fisher-Yates shuffle per card. Discards go back in after every round, so the
+// shoe is never changed and the pool is never used.
+
+/*===============================================================
+||                       Public Constants                      ||
+===============================================================*/
+const int NUM_DECKS = 8;                // The number of decks in each table's shoe
+const int SHOE_SIZE = NUM_DECKS * CARDS_IN_STANDARD_DECK;   // The number of cards in each table's shoe
+const int SHOE_CUT = SHOE_SIZE / 2;     // The cards dealt from a shoe before the table changes shoes
+// An unshuffled shoe, built at compile time and copied into each shoe before it is shuffled
+constexpr std::array<Card, SHOE_SIZE> STANDARD_SHOE = MakeShoe<NUM_DECKS>();
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// Where a table's spare shoe is on its way to being dealt
+enum ShoeStage {SHOE_QUEUED, SHOE_SHUFFLING, SHOE_READY};
+
+// The two shoes a table deals from. Only used through the functions below
+struct ShoeSupply
+{
+    ShoeRandom random;      // Shuffles every shoe. Only used by whoever is shuffling the spare
+    Card shoes[2][SHOE_SIZE];
+    int dealing = 1;        // The shoe the table is dealing from. The other is the spare
+    int undealt = 0;        // Dealing continuously: The cards at the start of shoes[0] not yet dealt
+    std::atomic<int> spareStage = SHOE_QUEUED;  // The ShoeStage of the spare
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         StartShoePool                         *
+*------------------------- Description -------------------------*
+* Starts the threads that shuffle spare shoes. Call once before *
+* any tables are made. Without them, tables shuffle their own   *
+* shoes when they change shoes.                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int count: The number of shuffling threads to start.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if every thread started.                         *
+* Returns false if a thread could not be set up.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool StartShoePool(const int count);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          PrepareShoe                          *
+*------------------------- Description -------------------------*
+* Hand a table's spare shoe to the pool to be refilled and      *
+* shuffled. Safe to call from any thread.                       *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::shared_ptr<ShoeSupply> &supply: The table's shoes. *
+*   Its random stream must be set.                              *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void PrepareShoe(const std::shared_ptr<ShoeSupply> &supply);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           NextShoe                            *
+*------------------------- Description -------------------------*
+* Move a table on to its spare shoe, and hand the shoe it was   *
+* dealing from to the pool. If the pool hasn't reached the spare*
+* yet, it is shuffled here instead. Only called by the table.   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::shared_ptr<ShoeSupply> &supply: The table's shoes. *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the shuffled cards to deal from, SHOE_SIZE of them.   *
+* They stay in place until the next call.                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+Card *NextShoe(const std::shared_ptr<ShoeSupply> &supply);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                      FillContinuousShoe                       *
+*------------------------- Description -------------------------*
+* Fill a table's shoe to be dealt from continuously with        *
+* DrawContinuous(). Never call NextShoe() on the same shoes.    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes.                        *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void FillContinuousShoe(ShoeSupply &supply);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         DrawContinuous                        *
+*------------------------- Description -------------------------*
+* Deal a card picked at random from the cards not yet dealt. The*
+* card is swapped to the end of the undealt cards, so every draw*
+* costs one random number and one swap.                         *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes, set up with            *
+*   FillContinuousShoe(). At least one card must be undealt.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the card dealt.                                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+Card DrawContinuous(ShoeSupply &supply);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                         ReturnDiscards                        *
+*------------------------- Description -------------------------*
+* Put every dealt card back into a continuous shoe. The dealt   *
+* cards are already held after the undealt ones, so this only   *
+* moves the boundary. Call once no cards are in play.           *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* ShoeSupply &supply: The table's shoes, set up with            *
+*   FillContinuousShoe().                                       *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ReturnDiscards(ShoeSupply &supply);
+
+#endif
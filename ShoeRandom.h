@@ -0,0 +1,197 @@
+#ifndef SHOERANDOM_H
+#define SHOERANDOM_H
+#include <cstdint>          // uint32_t, uint64_t
+#include "Card.h"           // Card
+
+// The random numbers each table shuffles its shoe with. Every table gets its own
+// xoshiro256** generator: 32 bytes of state, a few instructions per number, and no
+// system call once seeded. Tables are given streams jumped 2^128 numbers apart
+// from one master seed, so they never overlap, and a shoe can be dealt again
+// exactly from the master seed and the table's stream number: Seed() with the
+// master seed, then Jump() once per stream number.
+
+/*===============================================================
+||                       Public Constants                      ||
+===============================================================*/
+const int SHOE_RANDOM_STATE_SIZE = 4;   // The 64 bit words in a generator's state
+// The polynomial that moves a generator 2^128 numbers ahead
+const uint64_t SHOE_RANDOM_JUMP[SHOE_RANDOM_STATE_SIZE] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                                           0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// A xoshiro256** generator
+class ShoeRandom
+{
+    private:
+        /*===============================================================
+        ||                      Private Variables                      ||
+        ===============================================================*/
+        uint64_t state[SHOE_RANDOM_STATE_SIZE] = {};    // Never all zero once seeded
+
+        /*===============================================================
+        ||                      Private Functions                      ||
+        ===============================================================*/
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             Rotate                            *
+        *------------------------- Description -------------------------*
+        * Rotate the bits of a word left.                               *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const uint64_t word: The word to rotate.                      *
+        *                                                               *
+        * const int bits: How far to rotate it, from 1 to 63.           *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns the rotated word.                                     *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        static uint64_t Rotate(const uint64_t word, const int bits)
+        {
+            return (word << bits) | (word >> (64 - bits));
+        }
+
+    public:
+        /*===============================================================
+        ||                       Public Functions                      ||
+        ===============================================================*/
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Seed                             *
+        *------------------------- Description -------------------------*
+        * Start the generator from a seed. The state is filled by       *
+        * SplitMix64, so close seeds still give unrelated numbers.      *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const uint64_t seed: The seed.                                *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void Seed(uint64_t seed)
+        {
+            for (int i = 0; i < SHOE_RANDOM_STATE_SIZE; i++)
+            {
+                seed += 0x9e3779b97f4a7c15;
+                uint64_t mixed = seed;
+                mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9;
+                mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111eb;
+                state[i] = mixed ^ (mixed >> 31);
+            }
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Next                             *
+        *------------------------- Description -------------------------*
+        * Get the next random number.                                   *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns 64 random bits.                                       *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        uint64_t Next()
+        {
+            uint64_t result = Rotate(state[1] * 5, 7) * 9;
+            uint64_t shifted = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= shifted;
+            state[3] = Rotate(state[3], 45);
+            return result;
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                             Below                             *
+        *------------------------- Description -------------------------*
+        * Get a random number below a bound, with every number equally  *
+        * likely. Scales 32 random bits by the bound, and only draws    *
+        * again in the rare case that would favor some numbers.         *
+        *                                                               *
+        *------------------------- Parameters --------------------------*
+        * const uint32_t bound: One past the largest number wanted.     *
+        *   Must be at least 1.                                         *
+        *                                                               *
+        *------------------------- Return Value ------------------------*
+        * Returns a number from 0 to bound - 1.                         *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        uint32_t Below(const uint32_t bound)
+        {
+            uint64_t scaled = (Next() >> 32) * bound;
+            if ((uint32_t) scaled < bound)
+            {
+                uint32_t threshold = (0u - bound) % bound;
+                while ((uint32_t) scaled < threshold)
+                {
+                    scaled = (Next() >> 32) * bound;
+                }
+            }
+            return (uint32_t) (scaled >> 32);
+        }
+
+        /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+        *                              Jump                             *
+        *------------------------- Description -------------------------*
+        * Move the generator 2^128 numbers ahead, as if Next() had been *
+        * called that many times. Used to split one seed into streams   *
+        * that never overlap.                                           *
+        *                                                               *
+        *<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+        void Jump()
+        {
+            uint64_t jumped[SHOE_RANDOM_STATE_SIZE] = {};
+            for (int i = 0; i < SHOE_RANDOM_STATE_SIZE; i++)
+            {
+                for (int bit = 0; bit < 64; bit++)
+                {
+                    if (SHOE_RANDOM_JUMP[i] & ((uint64_t) 1 << bit))
+                    {
+                        for (int j = 0; j < SHOE_RANDOM_STATE_SIZE; j++)
+                        {
+                            jumped[j] ^= state[j];
+                        }
+                    }
+                    Next();
+                }
+            }
+            for (int j = 0; j < SHOE_RANDOM_STATE_SIZE; j++)
+            {
+                state[j] = jumped[j];
+            }
+        }
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                          ShuffleCards                         *
+*------------------------- Description -------------------------*
+* Shuffle cards in place with a Fisher-Yates shuffle. The same  *
+* generator state always gives the same order, whichever        *
+* standard library the server is built with.                    *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* Card cards[]: The cards to shuffle.                           *
+*                                                               *
+* const int count: The number of cards.                         *
+*                                                               *
+* ShoeRandom &random: The generator to shuffle with.            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+inline void ShuffleCards(Card cards[], const int count, ShoeRandom &random)
+{
+    for (int i = count - 1; i > 0; i--)
+    {
+        int j = random.Below(i + 1);
+        Card swapped = cards[i];
+        cards[i] = cards[j];
+        cards[j] = swapped;
+    }
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include "TableEngine.h" // My H file
+#include "ServerAPI.h"      // StartEventQueue, WatchSocket, RewatchSocket, UnwatchSocket, WaitForReadySockets
+#include <sys/eventfd.h>    // eventfd
+#include <pthread.h>        // pthread_create
+#include <unistd.h>         // read, write
+#include <cerrno>           // errno, EINTR
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*===============================================================
+||                      Private Constants                      ||
+===============================================================*/
+const int MAX_TABLE_EVENTS = 64;    // The most ready sockets handled per wake up
+
+/*===============================================================
+||                      Private Data Types                     ||
+===============================================================*/
+
+// A worker thread and the tables it runs
+struct TableWorker
+{
+    int eventQueue = -1;    // The sockets this worker's tables are waiting on
+    int wakeSignal = -1;    // Signaled when other threads hand this worker tables to resume
+
+    std::mutex postedLock;                      // Guards posted
+    std::vector<std::coroutine_handle<>> posted;// Tables to resume next, handed over by any thread
+
+    // The table waiting on each socket. The socket is used as the key. Only used by the worker
+    std::unordered_map<int, std::coroutine_handle<>> waiting;
+};
+
+/*===============================================================
+||                      Private Variables                      ||
+===============================================================*/
+std::vector<TableWorker*> workers;          // Every worker, set up once by StartTableWorkers()
+std::atomic<unsigned int> nextWorker(0);    // The worker the next table is handed to
+
+// The worker the calling thread is (nullptr on threads that aren't workers)
+thread_local TableWorker *currentWorker = nullptr;
+
+/*===============================================================
+||                      Private Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           PostTable                           *
+*------------------------- Description -------------------------*
+* Queue a table to be resumed by a worker, waking the worker.   *
+* Safe to call from any thread.                                 *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* TableWorker *worker: The worker the table runs on.            *
+*                                                               *
+* std::coroutine_handle<> table: The table to resume.           *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void PostTable(TableWorker *worker, std::coroutine_handle<> table)
+{
+    {
+        std::lock_guard<std::mutex> guard(worker->postedLock);
+        worker->posted.push_back(table);
+    }
+    uint64_t signal = 1;
+    while (write(worker->wakeSignal, &signal, sizeof(signal)) < 0 && errno == EINTR)
+    {
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                        *RunTableWorker                        *
+*------------------------- Description -------------------------*
+* A thread to run tables. It sleeps until one of its tables'    *
+* sockets has data or a table is handed to it, resumes that     *
+* table until it waits again, then goes back to sleep.          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* void *arg: The worker this thread is.                         *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void *RunTableWorker(void *arg)
+{
+    TableWorker *worker = (TableWorker *)arg;
+    currentWorker = worker;
+
+    int readySockets[MAX_TABLE_EVENTS];
+    std::vector<std::coroutine_handle<>> tables;
+    while (true)
+    {
+        int readyCount = WaitForReadySockets(worker->eventQueue, readySockets, MAX_TABLE_EVENTS);
+        for (int i = 0; i < readyCount; i++)
+        {
+            // resume every table handed over by another thread
+            if (readySockets[i] == worker->wakeSignal)
+            {
+                uint64_t signals;
+                while (read(worker->wakeSignal, &signals, sizeof(signals)) < 0 && errno == EINTR)
+                {
+                }
+                {
+                    std::lock_guard<std::mutex> guard(worker->postedLock);
+                    tables.swap(worker->posted);
+                }
+                RewatchSocket(worker->eventQueue, worker->wakeSignal);
+                for (std::coroutine_handle<> table : tables)
+                {
+                    table.resume();
+                }
+                tables.clear();
+                continue;
+            }
+
+            // resume the table waiting on the socket
+            auto found = worker->waiting.find(readySockets[i]);
+            if (found == worker->waiting.end())
+            {
+                continue;
+            }
+            std::coroutine_handle<> table = found->second;
+            worker->waiting.erase(found);
+            UnwatchSocket(worker->eventQueue, readySockets[i]);
+            table.resume();
+        }
+    }
+    return 0;
+}
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       StartTableWorkers                       *
+*------------------------- Description -------------------------*
+* Starts the worker threads that run every table. Each worker   *
+* waits on its own event queue and resumes whichever of its     *
+* tables has something to do, so one worker can run thousands of*
+* tables. Call once before RunTable().                          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int count: The number of worker threads to start.       *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if every worker started.                         *
+* Returns false if a worker could not be set up.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool StartTableWorkers(const int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        TableWorker *worker = new TableWorker;
+        worker->eventQueue = StartEventQueue();
+        worker->wakeSignal = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (worker->eventQueue < 0 || worker->wakeSignal < 0 || !WatchSocket(worker->eventQueue, worker->wakeSignal))
+        {
+            return false;
+        }
+
+        pthread_t newWorker;
+        if (pthread_create(&newWorker, NULL, RunTableWorker, (void *) worker) != 0)
+        {
+            return false;
+        }
+        workers.push_back(worker);
+    }
+    return !workers.empty();
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            RunTable                           *
+*------------------------- Description -------------------------*
+* Hands a table to the next worker, which starts running it.    *
+* The table stays on that worker and frees itself once it       *
+* finishes.                                                     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* TableTask table: The table to run.                            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void RunTable(TableTask table)
+{
+    TableWorker *worker = workers[nextWorker++ % workers.size()];
+    PostTable(worker, table.Release());
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           WakeTable                           *
+*------------------------- Description -------------------------*
+* Resumes the table parked in a waiter on its own worker. Does  *
+* nothing if no table is parked. Call while holding the lock    *
+* that was given to ParkTable.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* TableWaiter &waiter: Where the table is parked. Emptied.      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void WakeTable(TableWaiter &waiter)
+{
+    if (!waiter.table)
+    {
+        return;
+    }
+    PostTable(waiter.worker, waiter.table);
+    waiter.worker = nullptr;
+    waiter.table = nullptr;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                 WaitForReadable::await_suspend                *
+*------------------------- Description -------------------------*
+* Park the table until the socket has data to read. If the      *
+* socket can't be watched, the table is resumed right away so it*
+* finds out when it reads.                                      *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* std::coroutine_handle<> table: The table to park.             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void WaitForReadable::await_suspend(std::coroutine_handle<> table)
+{
+    if (!WatchSocket(currentWorker->eventQueue, socket))
+    {
+        PostTable(currentWorker, table);
+        return;
+    }
+    currentWorker->waiting[socket] = table;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                    ParkTable::await_suspend                   *
+*------------------------- Description -------------------------*
+* Park the table in the waiter and release the waiter's lock.   *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* std::coroutine_handle<> table: The table to park.             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void ParkTable::await_suspend(std::coroutine_handle<> table)
+{
+    waiter.worker = currentWorker;
+    waiter.table = table;
+    lock.unlock();
+}
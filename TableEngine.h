@@ -0,0 +1,166 @@
+#ifndef TABLEENGINE_H
+#define TABLEENGINE_H
+#include <coroutine>        // coroutine_handle, suspend_always, noop_coroutine
+#include <exception>        // terminate
+#include <mutex>            // mutex, unique_lock
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// A worker thread and the tables it runs. Only used through the functions below
+struct TableWorker;
+
+// A table, or one step of a table, written as a coroutine. Awaiting a TableTask runs it
+// on the awaiting table's worker and picks up where the awaiter left off once it finishes.
+class TableTask
+{
+    public:
+        struct promise_type;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        // Resumes whoever awaited the task, or frees a whole table once it is done
+        struct FinishTask
+        {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(Handle task) noexcept
+            {
+                std::coroutine_handle<> caller = task.promise().caller;
+                if (caller)
+                {
+                    return caller;
+                }
+                task.destroy();
+                return std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        struct promise_type
+        {
+            std::coroutine_handle<> caller; // The coroutine awaiting this one (none for a whole table)
+
+            TableTask get_return_object() { return TableTask(Handle::from_promise(*this)); }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinishTask final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+
+        // Starts the task once awaited, and resumes the awaiter when it finishes
+        struct RunTask
+        {
+            Handle task;
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+            {
+                task.promise().caller = caller;
+                return task;
+            }
+            void await_resume() const noexcept {}
+        };
+
+        TableTask(TableTask &&other) noexcept : task(other.task) { other.task = nullptr; }
+        ~TableTask()
+        {
+            if (task)
+            {
+                task.destroy();
+            }
+        }
+        RunTask operator co_await() const noexcept { return RunTask{task}; }
+
+        // Give up ownership, leaving the task to free itself when it finishes
+        Handle Release()
+        {
+            Handle released = task;
+            task = nullptr;
+            return released;
+        }
+
+    private:
+        Handle task;    // The coroutine this task owns
+
+        explicit TableTask(Handle task) : task(task) {}
+        TableTask(const TableTask&) = delete;
+        TableTask& operator=(const TableTask&) = delete;
+};
+
+// A table parked until something outside its worker wakes it with WakeTable()
+struct TableWaiter
+{
+    TableWorker *worker = nullptr;      // The worker the table runs on
+    std::coroutine_handle<> table;      // The parked table (none if nothing is parked)
+};
+
+// Awaited to park a table until a socket has data to read or has closed
+struct WaitForReadable
+{
+    int socket;     // The socket to wait on
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> table);
+    void await_resume() const noexcept {}
+};
+
+// Awaited to park a table in waiter until WakeTable() is called on it. The lock
+// guarding waiter is released while the table is parked and held again once it wakes
+struct ParkTable
+{
+    TableWaiter &waiter;                    // Where the table is parked
+    std::unique_lock<std::mutex> &lock;     // The lock guarding waiter
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> table);
+    void await_resume() { lock.lock(); }
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                       StartTableWorkers                       *
+*------------------------- Description -------------------------*
+* Starts the worker threads that run every table. Each worker   *
+* waits on its own event queue and resumes whichever of its     *
+* tables has something to do, so one worker can run thousands of*
+* tables. Call once before RunTable().                          *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const int count: The number of worker threads to start.       *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns true if every worker started.                         *
+* Returns false if a worker could not be set up.                *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+bool StartTableWorkers(const int count);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            RunTable                           *
+*------------------------- Description -------------------------*
+* Hands a table to the next worker, which starts running it.    *
+* The table stays on that worker and frees itself once it       *
+* finishes.                                                     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* TableTask table: The table to run.                            *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void RunTable(TableTask table);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                           WakeTable                           *
+*------------------------- Description -------------------------*
+* Resumes the table parked in a waiter on its own worker. Does  *
+* nothing if no table is parked. Call while holding the lock    *
+* that was given to ParkTable.                                  *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* TableWaiter &waiter: Where the table is parked. Emptied.      *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+void WakeTable(TableWaiter &waiter);
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef WIREFORMAT_H
+#define WIREFORMAT_H
+#include <cstdint>          // int32_t, uint32_t, uint8_t
+#include <string>           // string
+
+// The codes and field layouts of protocol 2, shared by the client and the server.
+// Protocol 1 spells each request as an 8 letter word and sends numbers as text.
+// Protocol 2 sends each request as one message: a one byte code, then its numbers
+// as 4 byte little-endian integers or its name as plain text. State frames are a
+// code, the sequence number, and fixed-width fields, with each card as one byte.
+// A client asks for protocol 2 once it connects, so clients that never ask keep
+// using protocol 1.
+
+/*===============================================================
+||                       Public Constants                      ||
+===============================================================*/
+const int PROTOCOL_VERSION = 2;         // The newest protocol spoken
+const int WIRE_INT_SIZE = 4;            // The bytes in each integer sent
+const int CARD_RANK_COUNT = 13;         // The number of card codes
+// The card each card code stands for
+const char* const CARD_NAMES[CARD_RANK_COUNT] = {"2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K", "A"};
+const uint8_t NO_CARD_CODE = 0xFF;      // Stands for a card with no code
+
+/*===============================================================
+||                      Public Data Types                      ||
+===============================================================*/
+
+// The code that starts each protocol 2 request. The values are part of the wire, so never reuse one
+enum RequestCode : uint8_t
+{
+    LIST_GAME_CODE = 1,     // See all available games
+    SUBSCRIBE_CODE = 2,     // Be pushed changes to the available games
+    SEARCH_CODE = 3,        // A page of the open games matching a search, followed by the search
+    CREATE_CODE = 4,        // Create a game, followed by its name
+    JOIN_CODE = 5,          // Join a game, followed by its name
+    JOIN_TABLE_CODE = 6,    // Join a game, followed by its table id
+    QUICK_JOIN_CODE = 7,    // Be seated at whichever table has a seat next
+    EXIT_CODE = 8,          // Be removed from the game
+    UNREGISTER_CODE = 9,    // Unregister from the server
+    BET_CODE = 10,          // Bet, followed by the amount
+    HIT_CODE = 11,          // Hit
+    STAND_CODE = 12,        // Stand
+    STATE_CONFIRM_CODE = 13,// Confirm states, followed by the last sequence number read
+    STATE_RESYNC_CODE = 14  // Ask for the whole state to be sent again
+};
+
+// The codes of the messages the server sends in protocol 2. Lobby lists and pushes stay text
+enum ReplyCode : uint8_t
+{
+    SERVER_TRUE_CODE = 'T',     // The answer if an action was valid
+    SERVER_FALSE_CODE = 'F',    // The answer if an action was invalid
+    FULL_STATE_CODE = 'S',      // Starts a state frame holding the whole state
+    CHANGED_STATE_CODE = 'D',   // Starts a state frame holding only what changed since the last
+    MONEY_CHANGED_CODE = 'M',   // A seat's money changed, followed by the seat and amount
+    BET_CHANGED_CODE = 'B',     // A seat's bet changed, followed by the seat and amount
+    CARDS_ADDED_CODE = 'C',     // Cards were added to a hand, followed by the seat and new cards
+    HAND_REPLACED_CODE = 'H'    // A hand was replaced, followed by the seat and whole hand
+};
+
+/*===============================================================
+||                       Public Functions                      ||
+===============================================================*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            PutInt32                           *
+*------------------------- Description -------------------------*
+* Write an integer as WIRE_INT_SIZE little-endian bytes.        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* char data[]: Where the bytes are written.                     *
+*                                                               *
+* const int32_t value: The integer to write.                    *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+inline void PutInt32(char data[], const int32_t value)
+{
+    uint32_t bits = (uint32_t) value;
+    data[0] = (char) (bits & 0xFF);
+    data[1] = (char) ((bits >> 8) & 0xFF);
+    data[2] = (char) ((bits >> 16) & 0xFF);
+    data[3] = (char) ((bits >> 24) & 0xFF);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            GetInt32                           *
+*------------------------- Description -------------------------*
+* Read an integer written by PutInt32().                        *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const char data[]: Where the bytes are read from.             *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the integer.                                          *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+inline int32_t GetInt32(const char data[])
+{
+    uint32_t bits = (uint32_t) (uint8_t) data[0]
+                  | ((uint32_t) (uint8_t) data[1] << 8)
+                  | ((uint32_t) (uint8_t) data[2] << 16)
+                  | ((uint32_t) (uint8_t) data[3] << 24);
+    return (int32_t) bits;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*
+*                            CardCode                           *
+*------------------------- Description -------------------------*
+* Find the one byte code a card is sent as.                     *
+*                                                               *
+*------------------------- Parameters --------------------------*
+* const std::string &card: The card, as named in CARD_NAMES.    *
+*                                                               *
+*------------------------- Return Value ------------------------*
+* Returns the index of the card in CARD_NAMES. Returns          *
+* NO_CARD_CODE if it is not a card.                             *
+*                                                               *
+*<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+inline uint8_t CardCode(const std::string &card)
+{
+    if (card.empty())
+    {
+        return NO_CARD_CODE;
+    }
+    switch (card[0])
+    {
+        // "10" is the only card with two letters
+        case '1':
+            return 8;
+        case 'J':
+            return 9;
+        case 'Q':
+            return 10;
+        case 'K':
+            return 11;
+        case 'A':
+            return 12;
+        default:
+            if (card[0] >= '2' && card[0] <= '9')
+            {
+                return (uint8_t) (card[0] - '2');
+            }
+            return NO_CARD_CODE;
+    }
+}
+
+#endif
@@ -0,0 +1,3 @@
+g++ -std=c++20 -O2 HandBatch.cpp HandBenchmark.cpp -o handBenchmark
+
+./handBenchmark 
\ No newline at end of file
@@ -0,0 +1,3 @@
+g++ -std=c++20 -O2 ClientAPI.cpp LobbyBenchmark.cpp -o lobbyBenchmark
+
+./lobbyBenchmark 
\ No newline at end of file
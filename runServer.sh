@@ -1,3 +1,3 @@
-g++ ServerAPI.cpp ServerConnection.cpp Server.cpp -o server
+g++ -std=c++20 ServerAPI.cpp IoUringTransport.cpp TableEngine.cpp ShoePool.cpp ServerConnection.cpp Server.cpp -o server -pthread
 
 ./server 
\ No newline at end of file